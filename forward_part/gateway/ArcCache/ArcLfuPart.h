@@ -2,6 +2,7 @@
 
 #include "ArcCacheNode.h"
 #include <unordered_map>
+#include <list>
 #include <map>
 #include <mutex>
 
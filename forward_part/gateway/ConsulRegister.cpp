@@ -1,6 +1,6 @@
 #include "ConsulRegister.h"
 
-void ConsulRegister::registerService()
+void ConsulRegister::registerService(std::function<void(bool ok)> done)
 {
 	Json::Value body;
 	body["Name"] = serviceName;
@@ -8,10 +8,20 @@ void ConsulRegister::registerService()
 	body["Address"] = address;
 	body["Port"] = port;
 
-	// 健康检查
-	body["Check"]["DeregisterCriticalServiceAfter"] = "30s";
-	body["Check"]["HTTP"] = "http://" + address + ":" + std::to_string(port) + "/health";
-	body["Check"]["Interval"] = "5s";
+	// 两个检查：存活失败过久才注销实例；就绪失败只让实例暂时不出现在 ?passing 查询里（nginx 不再选中），
+	// 恢复后自动回到可用列表，不会因为依赖的短暂故障把所有网关注销掉
+	const std::string base = "http://" + address + ":" + std::to_string(port);
+	Json::Value liveness;
+	liveness["Name"] = "liveness";
+	liveness["HTTP"] = base + "/health";
+	liveness["Interval"] = "5s";
+	liveness["DeregisterCriticalServiceAfter"] = "30s";
+	Json::Value readiness;
+	readiness["Name"] = "readiness";
+	readiness["HTTP"] = base + "/ready";
+	readiness["Interval"] = "5s";
+	body["Checks"].append(liveness);
+	body["Checks"].append(readiness);
 
 	auto client = drogon::HttpClient::newHttpClient(
 		"http://" + consulHost + ":" + std::to_string(consulPort));
@@ -20,12 +30,34 @@ void ConsulRegister::registerService()
 	req->setMethod(drogon::Put);
 	req->setPath("/v1/agent/service/register");
 
-	client->sendRequest(req, [](drogon::ReqResult result, const drogon::HttpResponsePtr &resp)
+	client->sendRequest(req, [done = std::move(done)](drogon::ReqResult result, const drogon::HttpResponsePtr &resp)
 						{
-            if (result == drogon::ReqResult::Ok)
+            const bool ok = result == drogon::ReqResult::Ok && resp && resp->statusCode() == drogon::k200OK;
+            if (ok)
                 LOG_INFO("Service registered to Consul");
             else
-                LOG_ERROR("Failed to register service"); });
+                LOG_ERROR("Failed to register service");
+            if (done)
+                done(ok); });
+}
+
+void ConsulRegister::checkRegistered(std::function<void(bool registered)> done)
+{
+	auto client = drogon::HttpClient::newHttpClient(
+		"http://" + consulHost + ":" + std::to_string(consulPort));
+
+	auto req = drogon::HttpRequest::newHttpRequest();
+	req->setMethod(drogon::Get);
+	req->setPath("/v1/agent/service/" + serviceId);
+
+	client->sendRequest(req, [done = std::move(done)](drogon::ReqResult result, const drogon::HttpResponsePtr &resp)
+						{
+            if (result != drogon::ReqResult::Ok || !resp)
+                return;
+            if (resp->statusCode() == drogon::k200OK)
+                done(true);
+            else if (resp->statusCode() == drogon::k404NotFound)
+                done(false); });
 }
 
 void ConsulRegister::deregister()
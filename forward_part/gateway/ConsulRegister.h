@@ -33,5 +33,9 @@ public:
 	{
 		deregister();
 	};
-	void registerService();
+	// done 在注册请求返回后调用（事件循环线程），ok 表示 Consul 接受了注册
+	void registerService(std::function<void(bool ok)> done = nullptr);
+	// 查询本实例是否仍在 Consul 中（存活检查失败过久会被注销）；
+	// registered 只在 Consul 明确答复时回调：200 为 true，404 为 false，请求失败不回调
+	void checkRegistered(std::function<void(bool registered)> done);
 };
@@ -6,9 +6,6 @@ class MyAppData
 public:
     std::string kafkaHost;
 	int kafkaPort;
-	std::string consulHost;
-	int consulPort;
-	std::string SigningKey;
 	static MyAppData &instance()
 	{
 		static MyAppData d;
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../ArcCache/ArcCache.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 已验证 token 中网关关心的声明
+struct JwtClaims
+{
+	int id = 0;
+	std::string name;
+	int64_t exp = 0;  // 过期时间（unix 秒）
+	std::string typ;  // 网关签发的 refresh token 为 "refresh"，access token 为空
+};
+
+// JWT 验证结果缓存
+// 客户端在 token 有效期内会反复携带同一个 token，命中缓存即可跳过 base64/JSON 解析和 HMAC 校验。
+// key 为 token 的 64 位哈希摘要，条目内保存完整 token，命中后逐字节比对，哈希碰撞不会串号。
+// 摘要刻意不用 SHA-256：对整段 token 做 SHA-256 的开销和 HS256 快速校验本身相当，缓存就失去意义了。
+// 按摘要分片，每个分片一把锁 + 一个 ARC 缓存，容量有界；条目以 shared_ptr 存放，ARC 内部拷贝不分配内存。
+// 签名密钥轮换时 clear() 递增代号，旧代号的条目一律视为未命中，用旧密钥签发的 token 必须重新校验。
+class JwtCache
+{
+public:
+	static JwtCache &instance()
+	{
+		static JwtCache cache;
+		return cache;
+	}
+
+	explicit JwtCache(size_t capacityPerShard = 1024, size_t shardCount = 16)
+	{
+		shards_.reserve(shardCount);
+		for (size_t i = 0; i < shardCount; ++i)
+			shards_.emplace_back(std::make_unique<Shard>(capacityPerShard));
+	}
+
+	// 命中且未过期返回 true；过期条目一律视为未命中
+	bool get(std::string_view token, JwtClaims &claims)
+	{
+		uint64_t key = digest(token);
+		Shard &shard = shardFor(key);
+		EntryPtr cached;
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			if (!shard.cache.get(key, cached))
+				return false;
+		}
+		if (!cached || cached->generation != generation() || cached->token != token ||
+			cached->claims.exp <= nowSeconds())
+			return false;
+		claims = cached->claims;
+		return true;
+	}
+
+	// 当前代号：校验 token 之前读取，校验通过后随 put 传回
+	uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+	// 使所有已缓存的条目失效（签名密钥轮换后调用，须在新密钥生效之后）
+	void clear() { generation_.fetch_add(1, std::memory_order_acq_rel); }
+
+	// 只缓存带 exp 且尚未过期的 token，保证缓存条目不会越过 token 自身的有效期；
+	// 校验期间发生过 clear()（可能是用旧密钥校验的）则不缓存
+	void put(std::string_view token, const JwtClaims &claims, uint64_t generation)
+	{
+		if (claims.exp <= nowSeconds() || generation != this->generation())
+			return;
+		uint64_t key = digest(token);
+		auto entry = std::make_shared<const Entry>(Entry{std::string(token), claims, generation});
+		Shard &shard = shardFor(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.cache.put(key, entry);
+	}
+
+private:
+	struct Entry
+	{
+		std::string token;
+		JwtClaims claims;
+		uint64_t generation;
+	};
+	using EntryPtr = std::shared_ptr<const Entry>;
+
+	struct Shard
+	{
+		explicit Shard(size_t capacity) : cache(capacity) {}
+		std::mutex mutex;
+		Cache::KArcCache<uint64_t, EntryPtr> cache;
+	};
+
+	static uint64_t digest(std::string_view token)
+	{
+		return std::hash<std::string_view>{}(token);
+	}
+
+	static int64_t nowSeconds()
+	{
+		return std::chrono::duration_cast<std::chrono::seconds>(
+				   std::chrono::system_clock::now().time_since_epoch())
+			.count();
+	}
+
+	Shard &shardFor(uint64_t key)
+	{
+		return *shards_[(key >> 56) % shards_.size()];
+	}
+
+	std::vector<std::unique_ptr<Shard>> shards_;
+	std::atomic<uint64_t> generation_{0};
+};
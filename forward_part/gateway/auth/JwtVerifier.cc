@@ -0,0 +1,500 @@
+#include "JwtVerifier.h"
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+#include <openssl/sha.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+	constexpr size_t kMaxHeaderBytes = 256; // 解码后 header 上限
+	constexpr size_t kMaxPayloadBytes = 1024;
+
+	std::mutex g_keyMutex;
+	std::string g_key;
+	// 0 表示尚未设置密钥
+	std::atomic<uint64_t> g_keyGeneration{0};
+
+	struct MacCtxDeleter
+	{
+		void operator()(EVP_MAC_CTX *ctx) const { EVP_MAC_CTX_free(ctx); }
+	};
+	using MacCtxPtr = std::unique_ptr<EVP_MAC_CTX, MacCtxDeleter>;
+
+	// HMAC 算法对象全进程共用，只 fetch 一次
+	EVP_MAC *hmacAlgorithm()
+	{
+		static EVP_MAC *mac = EVP_MAC_fetch(nullptr, OSSL_MAC_NAME_HMAC, nullptr);
+		return mac;
+	}
+
+	// 每个线程一个已用密钥初始化的 HMAC-SHA256 上下文，内部保存了吸收 key^ipad / key^opad 后的状态。
+	// 每个 token 用空密钥重新 init 即回到该状态，不重复处理密钥；比 EVP_MAC_CTX_dup 少一次分配和 provider 上下文复制
+	struct HmacSchedule
+	{
+		uint64_t generation = 0;
+		MacCtxPtr keyed;
+	};
+
+	bool threadSchedule(HmacSchedule *&out)
+	{
+		thread_local HmacSchedule schedule;
+		uint64_t generation = g_keyGeneration.load(std::memory_order_acquire);
+		if (generation == 0)
+			return false;
+		if (schedule.generation != generation)
+		{
+			EVP_MAC *mac = hmacAlgorithm();
+			MacCtxPtr ctx(mac ? EVP_MAC_CTX_new(mac) : nullptr);
+			if (!ctx)
+				return false;
+			char digest[] = "SHA256";
+			OSSL_PARAM params[] = {
+				OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+				OSSL_PARAM_construct_end(),
+			};
+			std::string key;
+			{
+				std::lock_guard<std::mutex> lock(g_keyMutex);
+				key = g_key;
+				generation = g_keyGeneration.load(std::memory_order_relaxed);
+			}
+			// 密钥指针不能为空（空指针表示沿用旧密钥），空密钥也传一个有效地址
+			static const unsigned char kEmpty = 0;
+			const unsigned char *keyData = key.empty() ? &kEmpty : reinterpret_cast<const unsigned char *>(key.data());
+			const bool ok = EVP_MAC_init(ctx.get(), keyData, key.size(), params) == 1;
+			OPENSSL_cleanse(key.data(), key.size());
+			if (!ok)
+				return false;
+			schedule.keyed = std::move(ctx);
+			schedule.generation = generation;
+		}
+		out = &schedule;
+		return true;
+	}
+
+	// 只在本线程的 schedule 上调用，上下文不跨线程共享
+	bool hmacSha256(const HmacSchedule &schedule, std::string_view data, unsigned char mac[SHA256_DIGEST_LENGTH])
+	{
+		EVP_MAC_CTX *ctx = schedule.keyed.get();
+		size_t macLen = 0;
+		return EVP_MAC_init(ctx, nullptr, 0, nullptr) == 1 &&
+			   EVP_MAC_update(ctx, reinterpret_cast<const unsigned char *>(data.data()), data.size()) == 1 &&
+			   EVP_MAC_final(ctx, mac, &macLen, SHA256_DIGEST_LENGTH) == 1 &&
+			   macLen == SHA256_DIGEST_LENGTH;
+	}
+
+	struct Base64UrlTable
+	{
+		int8_t v[256];
+		constexpr Base64UrlTable() : v()
+		{
+			for (int i = 0; i < 256; ++i)
+				v[i] = -1;
+			const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+			for (int i = 0; i < 64; ++i)
+				v[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+		}
+	};
+	constexpr Base64UrlTable kBase64Url;
+
+	// 解码 base64url（无填充），返回输出长度；非法输入返回 -1，超出 cap 返回 -2
+	int base64UrlDecode(std::string_view in, unsigned char *out, size_t cap)
+	{
+		while (!in.empty() && in.back() == '=')
+			in.remove_suffix(1);
+		if (in.size() % 4 == 1)
+			return -1;
+		size_t outLen = in.size() / 4 * 3 + (in.size() % 4 ? in.size() % 4 - 1 : 0);
+		if (outLen > cap)
+			return -2;
+
+		uint32_t acc = 0;
+		int bits = 0;
+		size_t n = 0;
+		for (char ch : in)
+		{
+			int8_t d = kBase64Url.v[static_cast<unsigned char>(ch)];
+			if (d < 0)
+				return -1;
+			acc = (acc << 6) | static_cast<uint32_t>(d);
+			bits += 6;
+			if (bits >= 8)
+			{
+				bits -= 8;
+				out[n++] = static_cast<unsigned char>(acc >> bits);
+			}
+		}
+		return static_cast<int>(n);
+	}
+
+	void base64UrlEncode(const unsigned char *in, size_t len, std::string &out)
+	{
+		static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+		uint32_t acc = 0;
+		int bits = 0;
+		for (size_t i = 0; i < len; ++i)
+		{
+			acc = (acc << 8) | in[i];
+			bits += 8;
+			while (bits >= 6)
+			{
+				bits -= 6;
+				out.push_back(alphabet[(acc >> bits) & 0x3F]);
+			}
+		}
+		if (bits > 0)
+			out.push_back(alphabet[(acc << (6 - bits)) & 0x3F]);
+	}
+
+	enum class Scan
+	{
+		kOk,
+		kBad,
+		kUnsupported,
+	};
+
+	// 极简 JSON 扫描：只认识顶层对象，按 key 取出需要的值，其余值跳过
+	class ClaimScanner
+	{
+	public:
+		ClaimScanner(const char *begin, const char *end) : p_(begin), end_(end) {}
+
+		// 逐个回调顶层 key；handler(key) 负责读取或跳过值
+		template <typename Handler>
+		Scan forEachMember(Handler &&handler)
+		{
+			skipWs();
+			if (!consume('{'))
+				return Scan::kBad;
+			skipWs();
+			if (consume('}'))
+				return Scan::kOk;
+			while (true)
+			{
+				std::string_view key;
+				bool escaped = false;
+				if (!rawString(key, escaped))
+					return Scan::kBad;
+				if (escaped)
+					return Scan::kUnsupported;
+				skipWs();
+				if (!consume(':'))
+					return Scan::kBad;
+				skipWs();
+				Scan r = handler(key);
+				if (r != Scan::kOk)
+					return r;
+				skipWs();
+				if (consume(','))
+				{
+					skipWs();
+					continue;
+				}
+				if (consume('}'))
+					return Scan::kOk;
+				return Scan::kBad;
+			}
+		}
+
+		Scan readInt(int64_t &value)
+		{
+			bool negative = consume('-');
+			if (p_ == end_ || *p_ < '0' || *p_ > '9')
+				return Scan::kBad;
+			int64_t v = 0;
+			int digits = 0;
+			while (p_ != end_ && *p_ >= '0' && *p_ <= '9')
+			{
+				if (++digits > 18)
+					return Scan::kUnsupported;
+				v = v * 10 + (*p_++ - '0');
+			}
+			// 浮点/科学计数法交给 jwt-cpp
+			if (p_ != end_ && (*p_ == '.' || *p_ == 'e' || *p_ == 'E'))
+				return Scan::kUnsupported;
+			value = negative ? -v : v;
+			return Scan::kOk;
+		}
+
+		// 读取字符串值；只处理简单转义，\uXXXX 交给 jwt-cpp
+		Scan readString(std::string &value)
+		{
+			std::string_view raw;
+			bool escaped = false;
+			if (!rawString(raw, escaped))
+				return Scan::kBad;
+			if (!escaped)
+			{
+				value.assign(raw.data(), raw.size());
+				return Scan::kOk;
+			}
+			value.clear();
+			value.reserve(raw.size());
+			for (size_t i = 0; i < raw.size(); ++i)
+			{
+				char c = raw[i];
+				if (c != '\\')
+				{
+					value.push_back(c);
+					continue;
+				}
+				switch (raw[++i])
+				{
+				case '"': value.push_back('"'); break;
+				case '\\': value.push_back('\\'); break;
+				case '/': value.push_back('/'); break;
+				case 'b': value.push_back('\b'); break;
+				case 'f': value.push_back('\f'); break;
+				case 'n': value.push_back('\n'); break;
+				case 'r': value.push_back('\r'); break;
+				case 't': value.push_back('\t'); break;
+				default: return Scan::kUnsupported;
+				}
+			}
+			return Scan::kOk;
+		}
+
+		// 字符串值与 expected 比较（不解转义，带转义即视为不支持）
+		Scan readStringEquals(std::string_view expected, bool &equal)
+		{
+			std::string_view raw;
+			bool escaped = false;
+			if (!rawString(raw, escaped))
+				return Scan::kBad;
+			if (escaped)
+				return Scan::kUnsupported;
+			equal = raw == expected;
+			return Scan::kOk;
+		}
+
+		Scan skipValue()
+		{
+			if (p_ == end_)
+				return Scan::kBad;
+			if (*p_ == '"')
+			{
+				std::string_view raw;
+				bool escaped = false;
+				return rawString(raw, escaped) ? Scan::kOk : Scan::kBad;
+			}
+			if (*p_ == '{' || *p_ == '[')
+			{
+				int depth = 0;
+				while (p_ != end_)
+				{
+					char c = *p_;
+					if (c == '"')
+					{
+						std::string_view raw;
+						bool escaped = false;
+						if (!rawString(raw, escaped))
+							return Scan::kBad;
+						continue;
+					}
+					++p_;
+					if (c == '{' || c == '[')
+						++depth;
+					else if ((c == '}' || c == ']') && --depth == 0)
+						return Scan::kOk;
+				}
+				return Scan::kBad;
+			}
+			// 数字 / true / false / null
+			const char *start = p_;
+			while (p_ != end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' && !isWs(*p_))
+				++p_;
+			return p_ != start ? Scan::kOk : Scan::kBad;
+		}
+
+	private:
+		static bool isWs(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+		void skipWs()
+		{
+			while (p_ != end_ && isWs(*p_))
+				++p_;
+		}
+
+		bool consume(char c)
+		{
+			if (p_ != end_ && *p_ == c)
+			{
+				++p_;
+				return true;
+			}
+			return false;
+		}
+
+		bool rawString(std::string_view &raw, bool &escaped)
+		{
+			if (!consume('"'))
+				return false;
+			const char *start = p_;
+			while (p_ != end_)
+			{
+				char c = *p_;
+				if (c == '"')
+				{
+					raw = std::string_view(start, static_cast<size_t>(p_ - start));
+					++p_;
+					return true;
+				}
+				if (c == '\\')
+				{
+					escaped = true;
+					if (++p_ == end_)
+						return false;
+				}
+				++p_;
+			}
+			return false;
+		}
+
+		const char *p_;
+		const char *end_;
+	};
+
+	JwtVerifier::Result toResult(Scan s)
+	{
+		return s == Scan::kUnsupported ? JwtVerifier::Result::kUnsupported : JwtVerifier::Result::kInvalid;
+	}
+}
+
+void JwtVerifier::setSigningKey(const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(g_keyMutex);
+	g_key = key;
+	g_keyGeneration.fetch_add(1, std::memory_order_release);
+}
+
+JwtVerifier::Result JwtVerifier::verify(std::string_view token, JwtClaims &claims)
+{
+	HmacSchedule *schedule = nullptr;
+	if (!threadSchedule(schedule))
+		return Result::kUnsupported;
+
+	size_t dot1 = token.find('.');
+	if (dot1 == std::string_view::npos)
+		return Result::kInvalid;
+	size_t dot2 = token.find('.', dot1 + 1);
+	if (dot2 == std::string_view::npos || token.find('.', dot2 + 1) != std::string_view::npos)
+		return Result::kInvalid;
+
+	// 1. 先校验签名，伪造 token 不会进入 JSON 解析
+	unsigned char signature[SHA256_DIGEST_LENGTH + 2];
+	if (base64UrlDecode(token.substr(dot2 + 1), signature, sizeof(signature)) != SHA256_DIGEST_LENGTH)
+		return Result::kInvalid;
+	unsigned char mac[SHA256_DIGEST_LENGTH];
+	if (!hmacSha256(*schedule, token.substr(0, dot2), mac))
+		return Result::kUnsupported;
+	if (CRYPTO_memcmp(mac, signature, SHA256_DIGEST_LENGTH) != 0)
+		return Result::kInvalid;
+
+	// 2. header：只接受 HS256
+	unsigned char header[kMaxHeaderBytes];
+	int headerLen = base64UrlDecode(token.substr(0, dot1), header, sizeof(header));
+	if (headerLen == -2)
+		return Result::kUnsupported;
+	if (headerLen < 0)
+		return Result::kInvalid;
+	bool isHs256 = false;
+	ClaimScanner headerScanner(reinterpret_cast<const char *>(header), reinterpret_cast<const char *>(header) + headerLen);
+	Scan s = headerScanner.forEachMember([&](std::string_view key)
+										 {
+		if (key == "alg")
+			return headerScanner.readStringEquals("HS256", isHs256);
+		return headerScanner.skipValue(); });
+	if (s != Scan::kOk)
+		return toResult(s);
+	if (!isHs256)
+		return Result::kUnsupported;
+
+	// 3. payload：提取声明
+	unsigned char payload[kMaxPayloadBytes];
+	int payloadLen = base64UrlDecode(token.substr(dot1 + 1, dot2 - dot1 - 1), payload, sizeof(payload));
+	if (payloadLen == -2)
+		return Result::kUnsupported;
+	if (payloadLen < 0)
+		return Result::kInvalid;
+
+	bool hasId = false, hasName = false, hasExp = false, hasNbf = false, hasIat = false;
+	bool issuerOk = false;
+	int64_t id = 0, exp = 0, nbf = 0, iat = 0;
+	claims.typ.clear();
+	ClaimScanner payloadScanner(reinterpret_cast<const char *>(payload), reinterpret_cast<const char *>(payload) + payloadLen);
+	s = payloadScanner.forEachMember([&](std::string_view key)
+									 {
+		if (key == "ID")
+		{
+			hasId = true;
+			return payloadScanner.readInt(id);
+		}
+		if (key == "Name")
+		{
+			hasName = true;
+			return payloadScanner.readString(claims.name);
+		}
+		if (key == "exp")
+		{
+			hasExp = true;
+			return payloadScanner.readInt(exp);
+		}
+		if (key == "nbf")
+		{
+			hasNbf = true;
+			return payloadScanner.readInt(nbf);
+		}
+		if (key == "iat")
+		{
+			hasIat = true;
+			return payloadScanner.readInt(iat);
+		}
+		if (key == "iss")
+			return payloadScanner.readStringEquals("Signin", issuerOk);
+		if (key == "typ")
+			return payloadScanner.readString(claims.typ);
+		return payloadScanner.skipValue(); });
+	if (s != Scan::kOk)
+		return toResult(s);
+
+	// 4. 与 jwt-cpp verify 保持一致的声明检查
+	if (!issuerOk || !hasId || !hasName)
+		return Result::kInvalid;
+	int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+					  std::chrono::system_clock::now().time_since_epoch())
+					  .count();
+	if (hasExp && now >= exp)
+		return Result::kExpired;
+	if ((hasNbf && now < nbf) || (hasIat && now < iat))
+		return Result::kInvalid;
+
+	claims.id = static_cast<int>(id);
+	claims.exp = hasExp ? exp : 0;
+	return Result::kOk;
+}
+
+std::string JwtVerifier::sign(std::string_view payloadJson)
+{
+	HmacSchedule *schedule = nullptr;
+	if (!threadSchedule(schedule))
+		return {};
+
+	// {"alg":"HS256","typ":"JWT"}
+	static const std::string kHeader = "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9";
+	std::string token;
+	token.reserve(kHeader.size() + 1 + (payloadJson.size() + 2) / 3 * 4 + 1 + 43);
+	token.append(kHeader).push_back('.');
+	base64UrlEncode(reinterpret_cast<const unsigned char *>(payloadJson.data()), payloadJson.size(), token);
+
+	unsigned char mac[SHA256_DIGEST_LENGTH];
+	if (!hmacSha256(*schedule, token, mac))
+		return {};
+	token.push_back('.');
+	base64UrlEncode(mac, sizeof(mac), token);
+	return token;
+}
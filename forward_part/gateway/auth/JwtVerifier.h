@@ -0,0 +1,30 @@
+#pragma once
+
+#include "JwtCache.h"
+#include <string>
+#include <string_view>
+
+// 面向本系统 token（HS256 + iss="Signin"）的快速校验路径
+// - 每个线程缓存一个已用密钥初始化的 HMAC 上下文（EVP_MAC），每个 token 只需重置后对 header.payload 做 SHA-256 收尾
+// - base64url 直接在 string_view 上解码到栈缓冲区，不分配内存
+// - 只提取 ID / Name / exp / iss / typ（及 nbf / iat 校验）这几个声明，不构建完整 JSON 树
+// 遇到超出快速路径能力范围的 token（非 HS256、过长、带 \u 转义等）返回 kUnsupported，由调用方回退到 jwt-cpp
+class JwtVerifier
+{
+public:
+	enum class Result
+	{
+		kOk,
+		kInvalid,
+		kExpired,
+		kUnsupported,
+	};
+
+	// 设置签名密钥；各线程在下一次校验时自动重建自己的 key schedule
+	static void setSigningKey(const std::string &key);
+
+	static Result verify(std::string_view token, JwtClaims &claims);
+
+	// 用同一套 key schedule 签发 HS256 token，payloadJson 为完整的 JSON 对象；未设置密钥时返回空串
+	static std::string sign(std::string_view payloadJson);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "JwtCache.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 网关本地签发 token
+// 登录成功后由网关签发短期 access token + 长期 refresh token（共享 AppConfig.jwt.secret）；
+// access 过期后客户端凭 refresh token 换取新的 access token，全程不调用后端服务。
+// refresh token 带 "typ":"refresh"，jwt_decode 过滤器拒绝用它访问业务接口。
+class TokenService
+{
+public:
+	static TokenService &instance()
+	{
+		static TokenService service;
+		return service;
+	}
+
+	void setTtl(int accessTtlSec, int refreshTtlSec)
+	{
+		accessTtl_.store(accessTtlSec, std::memory_order_relaxed);
+		refreshTtl_.store(refreshTtlSec, std::memory_order_relaxed);
+	}
+
+	int accessTtl() const { return accessTtl_.load(std::memory_order_relaxed); }
+	int refreshTtl() const { return refreshTtl_.load(std::memory_order_relaxed); }
+
+	// 签发 access token，exp 输出过期时间（unix 秒）；签名密钥未设置时返回空串
+	std::string issueAccess(int id, const std::string &name, int64_t &exp) const;
+
+	std::string issueRefresh(int id, const std::string &name) const;
+
+	// 校验 refresh token 并签发新的 access token；失败时 err 给出原因
+	bool refresh(std::string_view refreshToken, std::string &accessToken, int64_t &exp, std::string &err) const;
+
+private:
+	TokenService() = default;
+
+	static std::string issue(int id, const std::string &name, int ttlSec, bool refresh, int64_t &exp);
+
+	std::atomic<int> accessTtl_{900};
+	std::atomic<int> refreshTtl_{7 * 24 * 3600};
+};
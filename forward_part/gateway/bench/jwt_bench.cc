@@ -0,0 +1,128 @@
+// JWT 校验吞吐基准：jwt-cpp 完整路径 / JwtVerifier 快速路径 / JwtCache 命中
+// 用法：jwt_bench [seconds=3] [threads=1]
+// 输出每条路径的总吞吐和单核（单线程）吞吐
+#include "auth/JwtCache.h"
+#include "auth/JwtVerifier.h"
+#include <jwt-cpp/jwt.h>
+#include <openssl/hmac.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string base64Url(const std::string &in)
+{
+	static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	std::string out;
+	uint32_t acc = 0;
+	int bits = 0;
+	for (unsigned char c : in)
+	{
+		acc = (acc << 8) | c;
+		bits += 8;
+		while (bits >= 6)
+		{
+			bits -= 6;
+			out.push_back(alphabet[(acc >> bits) & 0x3F]);
+		}
+	}
+	if (bits > 0)
+		out.push_back(alphabet[(acc << (6 - bits)) & 0x3F]);
+	return out;
+}
+
+// 按 account_srv 签发的格式构造 token
+static std::string makeToken(const std::string &key)
+{
+	long exp = static_cast<long>(std::time(nullptr)) + 3600;
+	std::string header = R"({"alg":"HS256","typ":"JWT"})";
+	std::string payload = R"({"exp":)" + std::to_string(exp) + R"(,"iss":"Signin","ID":10086,"Name":"benchmark_user"})";
+	std::string signingInput = base64Url(header) + "." + base64Url(payload);
+
+	unsigned char mac[EVP_MAX_MD_SIZE];
+	unsigned int macLen = 0;
+	HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+		 reinterpret_cast<const unsigned char *>(signingInput.data()), signingInput.size(), mac, &macLen);
+	return signingInput + "." + base64Url(std::string(reinterpret_cast<char *>(mac), macLen));
+}
+
+static void run(const char *name, int seconds, int threads, const std::function<bool()> &op)
+{
+	std::atomic<bool> stop{false};
+	std::atomic<uint64_t> total{0};
+	std::atomic<uint64_t> failed{0};
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; ++i)
+	{
+		workers.emplace_back([&]()
+							 {
+			uint64_t n = 0, bad = 0;
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				for (int k = 0; k < 256; ++k)
+					bad += op() ? 0 : 1;
+				n += 256;
+			}
+			total += n;
+			failed += bad; });
+	}
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	stop = true;
+	for (auto &t : workers)
+		t.join();
+
+	double opsPerSec = static_cast<double>(total.load()) / seconds;
+	printf("%-10s threads=%d  %12.0f verify/s  %12.0f verify/s/core  failed=%llu\n",
+		   name, threads, opsPerSec, opsPerSec / threads, static_cast<unsigned long long>(failed.load()));
+}
+
+int main(int argc, char **argv)
+{
+	int seconds = argc > 1 ? std::atoi(argv[1]) : 3;
+	int threads = argc > 2 ? std::atoi(argv[2]) : 1;
+	if (seconds <= 0)
+		seconds = 3;
+	if (threads <= 0)
+		threads = 1;
+
+	const std::string key = "clouddisk-benchmark-signing-key";
+	const std::string token = makeToken(key);
+	JwtVerifier::setSigningKey(key);
+
+	run("jwt-cpp", seconds, threads, [&]()
+		{
+		try
+		{
+			auto decoded = jwt::decode(token);
+			jwt::verify()
+				.allow_algorithm(jwt::algorithm::hs256{key})
+				.with_issuer("Signin")
+				.verify(decoded);
+			int id = static_cast<int>(decoded.get_payload_claim("ID").as_integer());
+			std::string name = decoded.get_payload_claim("Name").as_string();
+			return id == 10086 && !name.empty();
+		}
+		catch (const std::exception &)
+		{
+			return false;
+		} });
+
+	run("fast-path", seconds, threads, [&]()
+		{
+		JwtClaims claims;
+		return JwtVerifier::verify(token, claims) == JwtVerifier::Result::kOk && claims.id == 10086; });
+
+	JwtCache cache;
+	JwtClaims seed;
+	JwtVerifier::verify(token, seed);
+	cache.put(token, seed, cache.generation());
+	run("cache-hit", seconds, threads, [&]()
+		{
+		JwtClaims claims;
+		return cache.get(token, claims) && claims.id == 10086; });
+	return 0;
+}
@@ -0,0 +1,207 @@
+#include "Bootstrap.h"
+#include "HealthProbe.h"
+#include "../ConsulRegister.h"
+#include "../cache/UserinfoCache.h"
+#include "../redis/GatewayRedis.h"
+#include "../../internal/consul.h"
+#include "../../logs/Logger.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	// 需要预热的后端服务（Consul 中的服务名）
+	const char *const kBackends[] = {"account_srv", "file_srv", "AI_srv"};
+	constexpr int kProbeTimeoutMs = 2000;
+}
+
+const char *Bootstrap::name(Component c)
+{
+	switch (c)
+	{
+	case Component::kConfig:
+		return "config";
+	case Component::kRedis:
+		return "redis";
+	case Component::kKafka:
+		return "kafka";
+	case Component::kConsul:
+		return "consul";
+	case Component::kChannels:
+		return "channels";
+	default:
+		return "unknown";
+	}
+}
+
+KafkaProducer::Options Bootstrap::kafkaOptions(const KafkaConfig &kafka)
+{
+	KafkaProducer::Options opts;
+	opts.lingerMs = kafka.linger_ms;
+	opts.batchNumMessages = kafka.batch_num_messages;
+	opts.queueMaxMessages = kafka.queue_max_messages;
+	opts.compression = kafka.compression;
+	return opts;
+}
+
+double Bootstrap::retryDelaySec(int attempt)
+{
+	return std::min(5.0, 0.2 * (1 << std::min(attempt, 5)));
+}
+
+void Bootstrap::start(const AppConfig &cfg, ConsulRegister &consul)
+{
+	const auto begin = std::chrono::steady_clock::now();
+	startRedis(cfg);
+	registerConsul(consul, 0);
+	threads_.emplace_back([this, &cfg]
+						  { startKafka(cfg); });
+	threads_.emplace_back([this, &cfg]
+						  { warmChannels(cfg); });
+	HealthProbe::instance().start();
+	LOG_INFO("[Bootstrap] dependency init dispatched in {}us",
+			 std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+}
+
+void Bootstrap::stop()
+{
+	stopping_.store(true, std::memory_order_release);
+	HealthProbe::instance().stop();
+	for (auto &t : threads_)
+	{
+		if (t.joinable())
+			t.join();
+	}
+	threads_.clear();
+}
+
+Json::Value Bootstrap::status() const
+{
+	Json::Value ret;
+	ret["ready"] = ready();
+	for (size_t i = 0; i < static_cast<size_t>(Component::kCount); ++i)
+	{
+		auto c = static_cast<Component>(i);
+		ret["components"][name(c)] = isReady(c);
+	}
+	return ret;
+}
+
+// 建客户端不阻塞（drogon 在自己的线程里连），随后用 PING 确认真正连上
+void Bootstrap::startRedis(const AppConfig &cfg)
+{
+	GatewayRedis::instance().init(cfg.redis.host, std::atoi(cfg.redis.port.c_str()),
+								  cfg.redis.connections_per_thread, drogon::app().getThreadNum());
+	pingRedis(0);
+}
+
+void Bootstrap::pingRedis(int attempt)
+{
+	if (stopping_.load(std::memory_order_acquire))
+		return;
+	auto redis = GatewayRedis::instance().client();
+	auto retry = [this, attempt]
+	{
+		drogon::app().getLoop()->runAfter(retryDelaySec(attempt), [this, attempt]
+										  { pingRedis(attempt + 1); });
+	};
+	if (!redis)
+		return retry();
+	redis->execCommandAsync(
+		[this](const drogon::nosql::RedisResult &)
+		{
+			const AppConfig &cfg = AppConfig::getInstance();
+			// 失效通知的订阅依赖 Redis 连接
+			UserinfoCache::instance().start(cfg.cache.userinfo_local_ttl_sec, cfg.cache.userinfo_redis_ttl_sec);
+			markReady(Component::kRedis);
+			LOG_INFO("[Bootstrap] redis ready");
+		},
+		[attempt, retry](const drogon::nosql::RedisException &err)
+		{
+			LOG_ERROR("[Bootstrap] redis ping failed (attempt {}): {}", attempt + 1, err.what());
+			retry();
+		},
+		"ping");
+}
+
+void Bootstrap::startKafka(const AppConfig &cfg)
+{
+	const std::string brokers = cfg.kafka.host + ":" + cfg.kafka.port;
+	const KafkaProducer::Options opts = kafkaOptions(cfg.kafka);
+
+	for (int attempt = 0; !stopping_.load(std::memory_order_acquire); ++attempt)
+	{
+		// start 只建句柄（配置非法时失败），probe 确认 broker 可达
+		if (KafkaProducer::instance().start(brokers, opts) && KafkaProducer::instance().probe(kProbeTimeoutMs))
+		{
+			markReady(Component::kKafka);
+			LOG_INFO("[Bootstrap] kafka ready: {}", brokers);
+			return;
+		}
+		LOG_ERROR("[Bootstrap] kafka not reachable (attempt {}): {}", attempt + 1, brokers);
+		std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(retryDelaySec(attempt) * 1000)));
+	}
+}
+
+void Bootstrap::registerConsul(ConsulRegister &consul, int attempt)
+{
+	if (stopping_.load(std::memory_order_acquire))
+		return;
+	consul.registerService([this, &consul, attempt](bool ok)
+						   {
+		if (ok)
+		{
+			markReady(Component::kConsul);
+			reregistering_.store(false, std::memory_order_release);
+			if (!watchingRegistration_.exchange(true))
+				watchRegistration(consul);
+			return;
+		}
+		drogon::app().getLoop()->runAfter(retryDelaySec(attempt), [this, &consul, attempt]
+										  { registerConsul(consul, attempt + 1); }); });
+}
+
+// 进程卡住过久被存活检查注销后，恢复时重新注册；Consul 不可达时不动，等下一轮
+void Bootstrap::watchRegistration(ConsulRegister &consul)
+{
+	drogon::app().getLoop()->runEvery(kRegistrationCheckSec, [this, &consul]
+									  {
+		if (stopping_.load(std::memory_order_acquire) || reregistering_.load(std::memory_order_acquire))
+			return;
+		consul.checkRegistered([this, &consul](bool registered)
+							   {
+			if (registered || reregistering_.exchange(true))
+				return;
+			LOG_ERROR("[Bootstrap] service missing from Consul, registering again");
+			markReady(Component::kConsul, false);
+			registerConsul(consul, 0); }); });
+}
+
+// 每个后端从 Consul 取一个实例建通道并等待连上；取不到实例或连不上不影响就绪，只记日志
+void Bootstrap::warmChannels(const AppConfig &cfg)
+{
+	CloudiskConsul consul(cfg.consul.host, std::atoi(cfg.consul.port.c_str()));
+	size_t warmed = 0;
+	for (const char *svc : kBackends)
+	{
+		if (stopping_.load(std::memory_order_acquire))
+			return;
+		ServiceInstance inst = consul.getRoundRobinInstance(svc);
+		if (inst.address.empty())
+		{
+			LOG_ERROR("[Bootstrap] no instance of {} to warm up", svc);
+			continue;
+		}
+		auto channel = grpc::CreateChannel(inst.address + ":" + std::to_string(inst.port),
+										   grpc::InsecureChannelCredentials());
+		if (channel->WaitForConnected(std::chrono::system_clock::now() + std::chrono::milliseconds(kProbeTimeoutMs)))
+			++warmed;
+		else
+			LOG_ERROR("[Bootstrap] channel to {} {}:{} not connected yet", svc, inst.address, inst.port);
+		// 通道交给 HealthProbe 保持存活并持续探测：gRPC 按目标地址复用子通道，控制器随后创建的同目标通道直接用上
+		HealthProbe::instance().watchChannel(svc, std::move(channel));
+	}
+	markReady(Component::kChannels, warmed == std::size(kBackends));
+	LOG_INFO("[Bootstrap] warmed {}/{} backend channel(s)", warmed, std::size(kBackends));
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../../internal/internal.h"
+#include "../../../other_srv/email_srv/KafkaProducer.h"
+#include <grpcpp/grpcpp.h>
+#include <json/json.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ConsulRegister;
+
+// 网关启动流水线
+// 监听端口先起来（/health 立即可用），各外部依赖在事件循环启动后并行初始化：
+// Redis（异步 PING）、Kafka（探测 broker）、Consul 注册（异步 HTTP）、后端 gRPC 通道预热。
+// 关键依赖（配置、Redis、Kafka）全部就绪后 ready() 才为 true，由 /ready 对外暴露；
+// 失败的依赖按退避在后台重试，不阻塞其它依赖，也不阻塞端口监听。
+// 启动完成后的持续探测见 HealthProbe。
+class Bootstrap
+{
+public:
+	enum class Component
+	{
+		kConfig,   // 已有可用配置（本地快照或 Nacos）
+		kRedis,	   // 关键
+		kKafka,	   // 关键
+		kConsul,   // 已注册到 Consul
+		kChannels, // 后端 gRPC 通道已预热
+		kCount,
+	};
+
+	static Bootstrap &instance()
+	{
+		static Bootstrap bootstrap;
+		return bootstrap;
+	}
+
+	// 在 beginning advice 中调用一次，立即返回
+	void start(const AppConfig &cfg, ConsulRegister &consul);
+
+	// 停止后台重试并等待初始化线程退出（进程退出前调用）
+	void stop();
+
+	void markReady(Component c, bool ready = true)
+	{
+		ready_[static_cast<size_t>(c)].store(ready, std::memory_order_release);
+	}
+
+	bool isReady(Component c) const
+	{
+		return ready_[static_cast<size_t>(c)].load(std::memory_order_acquire);
+	}
+
+	bool ready() const
+	{
+		return isReady(Component::kConfig) && isReady(Component::kRedis) && isReady(Component::kKafka);
+	}
+
+	// 各依赖状态，/ready 的响应体
+	Json::Value status() const;
+
+	static const char *name(Component c);
+
+	static KafkaProducer::Options kafkaOptions(const KafkaConfig &kafka);
+
+private:
+	Bootstrap() = default;
+
+	void startRedis(const AppConfig &cfg);
+	void pingRedis(int attempt);
+	void startKafka(const AppConfig &cfg);
+	void registerConsul(ConsulRegister &consul, int attempt);
+	void watchRegistration(ConsulRegister &consul);
+	void warmChannels(const AppConfig &cfg);
+
+	// 第 attempt 次失败后的重试间隔：200ms 起翻倍，封顶 5s
+	static double retryDelaySec(int attempt);
+	static constexpr double kRegistrationCheckSec = 15; // 检查本实例是否仍在 Consul 中的周期
+
+	std::atomic<bool> ready_[static_cast<size_t>(Component::kCount)]{};
+	std::atomic<bool> stopping_{false};
+	std::atomic<bool> watchingRegistration_{false};
+	std::atomic<bool> reregistering_{false};
+	std::vector<std::thread> threads_;
+};
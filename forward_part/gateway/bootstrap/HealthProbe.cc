@@ -0,0 +1,274 @@
+#include "HealthProbe.h"
+#include "../metrics/Metrics.h"
+#include "../redis/GatewayRedis.h"
+#include "../../internal/consul.h"
+#include "../../internal/internal.h"
+#include "../../logs/Logger.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	// 就绪依赖的后端服务（Consul 中的服务名）
+	const char *const kBackends[] = {"account_srv", "file_srv", "AI_srv"};
+	// 通道连续这么多轮处于失败状态后重新从 Consul 取实例（实例可能已下线）
+	constexpr int kReresolveRounds = 3;
+
+	int64_t nowUs()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+				   std::chrono::steady_clock::now().time_since_epoch())
+			.count();
+	}
+
+	const char *stateName(int state)
+	{
+		switch (state)
+		{
+		case GRPC_CHANNEL_IDLE:
+			return "idle";
+		case GRPC_CHANNEL_CONNECTING:
+			return "connecting";
+		case GRPC_CHANNEL_READY:
+			return "ready";
+		case GRPC_CHANNEL_TRANSIENT_FAILURE:
+			return "transient_failure";
+		case GRPC_CHANNEL_SHUTDOWN:
+			return "shutdown";
+		default:
+			return "no_instance";
+		}
+	}
+}
+
+HealthProbe::HealthProbe()
+{
+	for (const char *svc : kBackends)
+	{
+		backends_.emplace_back(new Backend);
+		backends_.back()->service = svc;
+	}
+}
+
+void HealthProbe::start()
+{
+	if (started_.exchange(true))
+		return;
+	const int64_t now = nowUs();
+	auto &reg = Metrics::Registry::instance();
+	for (trantor::EventLoop *loop : drogon::app().getIOLoops())
+	{
+		const std::string labels = "loop=\"" + std::to_string(loops_.size()) + "\"";
+		loops_.emplace_back(new LoopLag);
+		LoopLag *lag = loops_.back().get();
+		lag->loop = loop;
+		lag->lastTickUs.store(now, std::memory_order_relaxed);
+		lag->histogram = &reg.histogram("gateway_event_loop_lag_seconds", "How late the per-loop probe timer fired", labels);
+		lag->gauge = &reg.gauge("gateway_event_loop_lag_microseconds", "Current event loop lag, including stalls", labels);
+		scheduleTick(lag);
+	}
+	reg.addCollector([this]
+					 {
+		const int64_t t = nowUs();
+		for (const auto &lag : loops_)
+			lag->gauge->set(lagOf(*lag, t)); });
+	thread_ = std::thread([this]
+						  { run(); });
+}
+
+void HealthProbe::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(waitMutex_);
+		stopping_.store(true, std::memory_order_release);
+	}
+	waitCv_.notify_all();
+	if (thread_.joinable())
+		thread_.join();
+}
+
+void HealthProbe::watchChannel(const std::string &service, std::shared_ptr<grpc::Channel> channel)
+{
+	for (auto &backend : backends_)
+	{
+		if (backend->service != service)
+			continue;
+		std::lock_guard<std::mutex> lock(backend->mutex);
+		backend->state.store(channel->GetState(false), std::memory_order_release);
+		backend->channel = std::move(channel);
+		backend->failedRounds = 0;
+		return;
+	}
+}
+
+void HealthProbe::run()
+{
+	while (!stopping_.load(std::memory_order_acquire))
+	{
+		pingRedis();
+		for (auto &backend : backends_)
+			probeChannel(*backend);
+
+		std::unique_lock<std::mutex> lock(waitMutex_);
+		waitCv_.wait_for(lock, std::chrono::milliseconds(std::max(100, AppConfig::getInstance().health.probe_interval_ms)),
+						 [this]
+						 { return stopping_.load(std::memory_order_acquire); });
+	}
+}
+
+// 回调里只更新时间戳；超时或连接断开时不回调，成功时间戳变旧即视为不可用
+void HealthProbe::pingRedis()
+{
+	auto redis = GatewayRedis::instance().client();
+	if (!redis)
+		return;
+	const int64_t sentUs = nowUs();
+	redis->execCommandAsync(
+		[this, sentUs](const drogon::nosql::RedisResult &)
+		{
+			const int64_t now = nowUs();
+			redisLatencyUs_.store(now - sentUs, std::memory_order_relaxed);
+			redisOkUs_.store(now, std::memory_order_release);
+		},
+		[](const drogon::nosql::RedisException &err)
+		{
+			LOG_ERROR("[HealthProbe] redis ping failed: {}", err.what());
+		},
+		"ping");
+}
+
+void HealthProbe::probeChannel(Backend &backend)
+{
+	std::shared_ptr<grpc::Channel> channel;
+	{
+		std::lock_guard<std::mutex> lock(backend.mutex);
+		channel = backend.channel;
+		if (channel)
+			backend.failedRounds = channelOk(channel->GetState(false)) ? 0 : backend.failedRounds + 1;
+		if (channel && backend.failedRounds < kReresolveRounds)
+		{
+			// try_to_connect：IDLE 的通道也主动建连，断开后尽快重连
+			backend.state.store(channel->GetState(true), std::memory_order_release);
+			return;
+		}
+	}
+
+	// 没有通道或长时间连不上：重新解析（同步 HTTP，只在探测线程中做）
+	const ConsulConfig &consulCfg = AppConfig::getInstance().consul;
+	CloudiskConsul consul(consulCfg.host, std::atoi(consulCfg.port.c_str()));
+	ServiceInstance inst = consul.getRoundRobinInstance(backend.service);
+	std::lock_guard<std::mutex> lock(backend.mutex);
+	backend.failedRounds = 0;
+	if (inst.address.empty())
+	{
+		backend.channel.reset();
+		backend.state.store(-1, std::memory_order_release);
+		return;
+	}
+	backend.channel = grpc::CreateChannel(inst.address + ":" + std::to_string(inst.port),
+										  grpc::InsecureChannelCredentials());
+	backend.state.store(backend.channel->GetState(true), std::memory_order_release);
+}
+
+// 定时器按当前配置的周期自我续期；实际触发时刻晚于预期的部分就是循环里排队的时间
+void HealthProbe::scheduleTick(LoopLag *lag)
+{
+	const double intervalSec = std::max(100, AppConfig::getInstance().health.probe_interval_ms) / 1000.0;
+	const int64_t expectedUs = nowUs() + static_cast<int64_t>(intervalSec * 1e6);
+	lag->loop->runAfter(intervalSec, [this, lag, expectedUs]
+						{
+		if (stopping_.load(std::memory_order_acquire))
+			return;
+		const int64_t now = nowUs();
+		const int64_t lagUs = std::max<int64_t>(0, now - expectedUs);
+		lag->lagUs.store(lagUs, std::memory_order_relaxed);
+		lag->histogram->observe(static_cast<double>(lagUs) / 1e6);
+		lag->lastTickUs.store(now, std::memory_order_relaxed);
+		scheduleTick(lag); });
+}
+
+// 循环完全卡住时定时器不会触发，此时按距上次触发的时间估算
+int64_t HealthProbe::lagOf(const LoopLag &lag, int64_t nowUs) const
+{
+	const int64_t intervalUs = std::max(100, AppConfig::getInstance().health.probe_interval_ms) * 1000LL;
+	const int64_t stalledUs = nowUs - lag.lastTickUs.load(std::memory_order_relaxed) - intervalUs;
+	return std::max(lag.lagUs.load(std::memory_order_relaxed), stalledUs);
+}
+
+bool HealthProbe::redisOk(int64_t nowUs) const
+{
+	const int64_t okUs = redisOkUs_.load(std::memory_order_acquire);
+	return okUs != 0 && nowUs - okUs <= AppConfig::getInstance().health.redis_max_age_ms * 1000LL;
+}
+
+bool HealthProbe::required(const std::string &service)
+{
+	const auto &required = AppConfig::getInstance().health.required_backends;
+	return std::find(required.begin(), required.end(), service) != required.end();
+}
+
+// IDLE / CONNECTING 视为可用：空闲通道收到请求即会建连
+bool HealthProbe::channelOk(int state)
+{
+	return state == GRPC_CHANNEL_IDLE || state == GRPC_CHANNEL_CONNECTING || state == GRPC_CHANNEL_READY;
+}
+
+std::vector<int64_t> HealthProbe::loopLagUs() const
+{
+	const int64_t now = nowUs();
+	std::vector<int64_t> ret;
+	ret.reserve(loops_.size());
+	for (const auto &lag : loops_)
+		ret.push_back(lagOf(*lag, now));
+	return ret;
+}
+
+bool HealthProbe::ready() const
+{
+	if (!started_.load(std::memory_order_acquire))
+		return false;
+	const int64_t now = nowUs();
+	if (!redisOk(now))
+		return false;
+	for (const auto &backend : backends_)
+	{
+		if (required(backend->service) && !channelOk(backend->state.load(std::memory_order_acquire)))
+			return false;
+	}
+	const int64_t maxLagUs = AppConfig::getInstance().health.max_loop_lag_ms * 1000LL;
+	for (const auto &lag : loops_)
+	{
+		if (lagOf(*lag, now) > maxLagUs)
+			return false;
+	}
+	return true;
+}
+
+Json::Value HealthProbe::status() const
+{
+	const int64_t now = nowUs();
+	Json::Value ret;
+	ret["ready"] = ready();
+
+	const int64_t okUs = redisOkUs_.load(std::memory_order_acquire);
+	ret["redis"]["ok"] = redisOk(now);
+	ret["redis"]["last_ok_age_ms"] = okUs == 0 ? Json::Value(-1) : Json::Value(static_cast<Json::Int64>((now - okUs) / 1000));
+	ret["redis"]["latency_us"] = static_cast<Json::Int64>(redisLatencyUs_.load(std::memory_order_relaxed));
+
+	ret["degraded"] = Json::arrayValue;
+	for (const auto &backend : backends_)
+	{
+		const int state = backend->state.load(std::memory_order_acquire);
+		ret["channels"][backend->service]["ok"] = channelOk(state);
+		ret["channels"][backend->service]["state"] = stateName(state);
+		ret["channels"][backend->service]["required"] = required(backend->service);
+		if (!channelOk(state))
+			ret["degraded"].append(backend->service);
+	}
+
+	ret["loop_lag_ms"] = Json::arrayValue;
+	for (int64_t lagUs : loopLagUs())
+		ret["loop_lag_ms"].append(static_cast<double>(lagUs) / 1000.0);
+	return ret;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+#include <json/json.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trantor
+{
+	class EventLoop;
+}
+
+namespace Metrics
+{
+	class Gauge;
+	class Histogram;
+}
+
+// 就绪探测：依赖状态由后台周期性探测并缓存在原子变量里，/ready 只读缓存，不在请求路径上做 IO
+// - Redis：异步 PING，记录最近一次成功的时间和往返耗时
+// - 后端 gRPC 通道：account_srv / file_srv / AI_srv 的连接状态；默认只报告（degraded），不参与就绪判断
+//   （与控制器连到同一目标，gRPC 按目标复用子通道，看到的就是控制器实际使用的连接）
+// - 事件循环延迟：每个 IO 循环上挂一个定时器，实际触发时间晚于预期的部分即排队延迟，同时导出到 /metrics
+class HealthProbe
+{
+public:
+	static HealthProbe &instance()
+	{
+		static HealthProbe probe;
+		return probe;
+	}
+
+	// 事件循环起来后调用一次（beginning advice 中），周期取 AppConfig::health，热更新即时生效
+	void start();
+	void stop();
+
+	// 接管启动预热时建好的通道，之后由探测线程维护（断开过久会重新从 Consul 解析）
+	void watchChannel(const std::string &service, std::shared_ptr<grpc::Channel> channel);
+
+	bool ready() const;
+	// 各探测项的详细状态，/ready 的响应体
+	Json::Value status() const;
+
+	// 各 IO 循环当前的延迟（微秒）
+	std::vector<int64_t> loopLagUs() const;
+
+private:
+	struct Backend
+	{
+		std::string service;
+		std::mutex mutex; // 只在探测线程和 watchChannel 之间竞争
+		std::shared_ptr<grpc::Channel> channel;
+		std::atomic<int> state{-1}; // grpc_connectivity_state，-1 表示还没有可用实例
+		int failedRounds = 0;
+	};
+
+	struct LoopLag
+	{
+		trantor::EventLoop *loop = nullptr;
+		std::atomic<int64_t> lagUs{0};
+		std::atomic<int64_t> lastTickUs{0};
+		Metrics::Histogram *histogram = nullptr; // 每次触发的延迟分布，只在该循环线程写
+		Metrics::Gauge *gauge = nullptr;		 // 当前延迟（含卡死估算），导出时刷新
+	};
+
+	HealthProbe();
+
+	void run();
+	void pingRedis();
+	void probeChannel(Backend &backend);
+	void scheduleTick(LoopLag *lag);
+	int64_t lagOf(const LoopLag &lag, int64_t nowUs) const;
+	bool redisOk(int64_t nowUs) const;
+	static bool channelOk(int state);
+	// 该后端不可用时是否使网关不就绪（AppConfig::health.required_backends）
+	static bool required(const std::string &service);
+
+	std::vector<std::unique_ptr<Backend>> backends_;
+	std::vector<std::unique_ptr<LoopLag>> loops_;
+
+	std::atomic<int64_t> redisOkUs_{0};		 // 最近一次 PING 成功的时刻（steady 微秒），0 表示从未成功
+	std::atomic<int64_t> redisLatencyUs_{0}; // 最近一次成功 PING 的往返耗时
+
+	std::atomic<bool> started_{false};
+	std::atomic<bool> stopping_{false};
+	std::mutex waitMutex_;
+	std::condition_variable waitCv_;
+	std::thread thread_;
+};
@@ -0,0 +1,136 @@
+#include "UserinfoCache.h"
+#include "../../logs/Logger.h"
+#include "../redis/GatewayRedis.h"
+
+namespace
+{
+	const char *const kInvalidateChannel = "userinfo:invalidate";
+}
+
+UserinfoCache::UserinfoCache(size_t capacityPerShard, size_t shardCount)
+{
+	shards_.reserve(shardCount);
+	for (size_t i = 0; i < shardCount; ++i)
+		shards_.emplace_back(std::make_unique<Shard>(capacityPerShard));
+}
+
+void UserinfoCache::start(int localTtlSec, int redisTtlSec)
+{
+	setTtl(localTtlSec, redisTtlSec);
+
+	auto redis = GatewayRedis::instance().client();
+	if (!redis)
+	{
+		LOG_ERROR("[UserinfoCache] redis client unavailable, cross-replica invalidation disabled");
+		return;
+	}
+	subscriber_ = redis->newSubscriber();
+	subscriber_->subscribe(kInvalidateChannel,
+						   [this](const std::string &, const std::string &message)
+						   {
+							   try
+							   {
+								   eraseLocal(std::stoi(message));
+							   }
+							   catch (const std::exception &e)
+							   {
+								   LOG_ERROR("[UserinfoCache] bad invalidate message {}: {}", message, e.what());
+							   }
+						   });
+}
+
+bool UserinfoCache::getLocal(int id, std::string &message)
+{
+	Shard &shard = shardFor(id);
+	EntryPtr entry;
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (!shard.cache.get(id, entry))
+			return false;
+	}
+	if (!entry || entry->expireAt <= std::chrono::steady_clock::now())
+		return false;
+	message = entry->message;
+	return true;
+}
+
+void UserinfoCache::getShared(int id, std::function<void(bool, const std::string &)> &&cb)
+{
+	auto redis = GatewayRedis::instance().client();
+	if (!redis)
+		return cb(false, std::string());
+
+	auto done = std::make_shared<std::function<void(bool, const std::string &)>>(std::move(cb));
+	redis->execCommandAsync(
+		[this, id, done](const drogon::nosql::RedisResult &r)
+		{
+			if (r.type() != drogon::nosql::RedisResultType::kString)
+				return (*done)(false, std::string());
+			std::string message = r.asString();
+			putLocal(id, message);
+			(*done)(true, message);
+		},
+		[done](const drogon::nosql::RedisException &err)
+		{
+			LOG_ERROR("[UserinfoCache] redis get failed: {}", err.what());
+			(*done)(false, std::string());
+		},
+		"get %s", redisKey(id).c_str());
+}
+
+void UserinfoCache::put(int id, const std::string &message, uint64_t epoch)
+{
+	if (epoch != this->epoch())
+		return;
+	putLocal(id, message);
+
+	auto redis = GatewayRedis::instance().client();
+	if (!redis)
+		return;
+	redis->execCommandAsync(
+		[](const drogon::nosql::RedisResult &) {},
+		[](const drogon::nosql::RedisException &err)
+		{ LOG_ERROR("[UserinfoCache] redis setex failed: {}", err.what()); },
+		"setex %s %d %s", redisKey(id).c_str(), redisTtlSec_.load(std::memory_order_relaxed), message.c_str());
+}
+
+void UserinfoCache::invalidate(int id)
+{
+	epoch_.fetch_add(1, std::memory_order_acq_rel);
+	eraseLocal(id);
+
+	auto redis = GatewayRedis::instance().client();
+	if (!redis)
+		return;
+	std::string idStr = std::to_string(id);
+	redis->execCommandAsync(
+		[redis, idStr](const drogon::nosql::RedisResult &)
+		{
+			// 先删共享副本再广播，其它副本回源时不会再读到旧值
+			redis->execCommandAsync(
+				[](const drogon::nosql::RedisResult &) {},
+				[](const drogon::nosql::RedisException &err)
+				{ LOG_ERROR("[UserinfoCache] publish failed: {}", err.what()); },
+				"publish %s %s", kInvalidateChannel, idStr.c_str());
+		},
+		[](const drogon::nosql::RedisException &err)
+		{ LOG_ERROR("[UserinfoCache] redis del failed: {}", err.what()); },
+		"del %s", redisKey(id).c_str());
+}
+
+void UserinfoCache::putLocal(int id, const std::string &message)
+{
+	auto ttl = std::chrono::seconds(localTtlSec_.load(std::memory_order_relaxed));
+	auto entry = std::make_shared<const Entry>(Entry{message, std::chrono::steady_clock::now() + ttl});
+	Shard &shard = shardFor(id);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.cache.put(id, entry);
+}
+
+void UserinfoCache::eraseLocal(int id)
+{
+	auto tombstone = std::make_shared<const Entry>(Entry{std::string(), std::chrono::steady_clock::time_point{}});
+	Shard &shard = shardFor(id);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.cache.put(id, tombstone);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../ArcCache/ArcCache.h"
+#include <drogon/drogon.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Userinfo 结果缓存（按 JWT 中的用户 ID）
+// 两级：本进程分片 ARC（短 TTL）+ Redis userinfo:{id}（较长 TTL，多个网关副本共享）。
+// 资料变更时调用 invalidate()：删本地、删 Redis，并通过 Redis PUBLISH 通知其它副本删本地。
+class UserinfoCache
+{
+public:
+	static UserinfoCache &instance()
+	{
+		static UserinfoCache cache;
+		return cache;
+	}
+
+	// 在 Redis 客户端创建之后调用（beginning advice 中），订阅失效通知；
+	// Redis 客户端被替换（配置热更新）后再次调用，在新连接上重新订阅
+	void start(int localTtlSec = 30, int redisTtlSec = 300);
+
+	void setTtl(int localTtlSec, int redisTtlSec)
+	{
+		localTtlSec_.store(localTtlSec, std::memory_order_relaxed);
+		redisTtlSec_.store(redisTtlSec, std::memory_order_relaxed);
+	}
+
+	// 本地命中返回 true
+	bool getLocal(int id, std::string &message);
+
+	// 查 Redis，结果回调在 Redis 客户端线程执行；未命中或出错时 found=false
+	void getShared(int id, std::function<void(bool found, const std::string &message)> &&cb);
+
+	// 写入两级缓存；epoch 为发起查询前 epoch() 的返回值，期间发生过失效则丢弃，避免旧数据回填
+	void put(int id, const std::string &message, uint64_t epoch);
+
+	// 资料变更后的失效入口
+	void invalidate(int id);
+
+	uint64_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+
+private:
+	struct Entry
+	{
+		std::string message;
+		std::chrono::steady_clock::time_point expireAt;
+	};
+	using EntryPtr = std::shared_ptr<const Entry>;
+
+	struct Shard
+	{
+		explicit Shard(size_t capacity) : cache(capacity) {}
+		std::mutex mutex;
+		Cache::KArcCache<int, EntryPtr> cache;
+	};
+
+	UserinfoCache(size_t capacityPerShard = 512, size_t shardCount = 16);
+
+	static std::string redisKey(int id) { return "userinfo:" + std::to_string(id); }
+
+	Shard &shardFor(int id) { return *shards_[static_cast<unsigned>(id) % shards_.size()]; }
+	void putLocal(int id, const std::string &message);
+	// ARC 没有删除接口，写入一个已过期的墓碑条目即可让后续 get 视为未命中
+	void eraseLocal(int id);
+
+	std::vector<std::unique_ptr<Shard>> shards_;
+	std::atomic<int> localTtlSec_{30};
+	std::atomic<int> redisTtlSec_{300};
+	std::atomic<uint64_t> epoch_{0};
+	std::shared_ptr<drogon::nosql::RedisSubscriber> subscriber_;
+};
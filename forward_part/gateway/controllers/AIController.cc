@@ -1,4 +1,6 @@
 #include "AIController.h"
+#include "ProtoCodec.h"
+#include "../metrics/Metrics.h"
 #include <json/json.h>
 
 // 解析 JSON 字符串
@@ -25,19 +27,21 @@ std::shared_ptr<AI::AIService::Stub> AIController::FindService(const std::string
 	ServiceInstance value;
 
 	// 1. 尝试从缓存取
+	static Metrics::CacheStats cacheStats("service_instance");
 	if (cache_.get(key, value))
 	{
 		if (value.channel && isChannelReady(value.channel))
 		{
-			LOG_INFO("[ARC] HIT key = {}, addr = {}:{}", key, value.address, value.port);
+			cacheStats.record(true);
+			LOG_INFO_SAMPLED("[ARC] HIT key = {}, addr = {}:{}", key, value.address, value.port);
 			return value.AI_stub; // ✔缓存有效
 		}
 		LOG_INFO("[ARC] MISS key = {}", key);
 	}
-	// 2. 未命中缓存 → 去 Consul 查询
-	std::string host = MyAppData::instance().consulHost;
-	int port = MyAppData::instance().consulPort;
-	CloudiskConsul consul(host, port);
+	cacheStats.record(false);
+	// 2. 未命中缓存 → 去 Consul 查询（地址取当前配置快照，热更新后立即生效）
+	const ConsulConfig &consulCfg = AppConfig::getInstance().consul;
+	CloudiskConsul consul(consulCfg.host, std::atoi(consulCfg.port.c_str()));
 	value = consul.getRoundRobinInstance(key);
 
 	if (value.address.empty())
@@ -61,8 +65,11 @@ void AIController::aiRequest(const HttpRequestPtr &req,
 {
 	// 1) 查找 AI 服务实例
 	auto stub = FindService("AI_srv");
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
 	if (!stub)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::AI::AIResp>(k500InternalServerError, "no_ai_service"));
 		Json::Value ret;
 		ret["error"] = "no_ai_service";
 		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
@@ -97,8 +104,19 @@ void AIController::aiRequest(const HttpRequestPtr &req,
 	std::string filehash;
 	int32_t fileSize = 0;
 
+	// 3.0 protobuf 客户端直接发 AIReq，身份字段稍后以 JWT 覆盖
+	if (ProtoCodec::isProtobufRequest(req))
+	{
+		::AI::AIReq pb;
+		if (!ProtoCodec::parseRequest(req, pb))
+			return callback(ProtoCodec::newErrorResponse<::AI::AIResp>(k400BadRequest, "invalid_protobuf"));
+		query = pb.query();
+		filename = pb.filename();
+		filehash = pb.filehash();
+		fileSize = pb.file_size();
+	}
 	// 3.1 优先从 JSON body 取
-	if (req->contentType() == drogon::CT_APPLICATION_JSON)
+	else if (req->contentType() == drogon::CT_APPLICATION_JSON)
 	{
 		auto json = req->getJsonObject();
 		if (json)
@@ -158,10 +176,19 @@ void AIController::aiRequest(const HttpRequestPtr &req,
 	if (fileSize > 0)
 		request->set_file_size(fileSize);
 
+	static const Metrics::RpcMetrics rpcMetrics("AI_srv", "AIrequest");
+	const auto rpcTimer = rpcMetrics.start();
 	// 5) 发起异步 gRPC
 	stub->async()->AIrequest(context.get(), request.get(), response.get(),
-							 [context, request, response, callback](::grpc::Status status)
+							 [context, request, response, callback, protobuf, rpcTimer](::grpc::Status status)
 							 {
+								 rpcTimer.finish(status.ok());
+								 // protobuf 客户端自行解释 AIResp.data，网关只做透传
+								 if (protobuf)
+								 {
+									 callback(ProtoCodec::newRpcResponse(status, *response, 200));
+									 return;
+								 }
 								 // 5.1 gRPC 层失败
 								 if (!status.ok() || response == nullptr)
 								 {
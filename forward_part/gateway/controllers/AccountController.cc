@@ -1,4 +1,11 @@
 #include "AccountController.h"
+#include "ProtoCodec.h"
+#include "../auth/JwtVerifier.h"
+#include "../auth/TokenService.h"
+#include "../cache/UserinfoCache.h"
+#include "../metrics/Metrics.h"
+#include "../ratelimit/RateLimiter.h"
+#include "../redis/GatewayRedis.h"
 #include "../../../other_srv/email_srv/KafkaProducer.h"
 
 drogon::HttpResponsePtr transError(const std::string &status, const std::string &msg, HttpStatusCode code)
@@ -12,6 +19,35 @@ drogon::HttpResponsePtr transError(const std::string &status, const std::string
 	return resp;
 }
 
+// 按客户端协商结果返回 JSON 或 account::Resp
+static drogon::HttpResponsePtr transResp(bool protobuf, const std::string &status, const std::string &msg, HttpStatusCode code)
+{
+	if (!protobuf)
+		return transError(status, msg, code);
+	::account::Resp resp;
+	resp.set_code(code == k200OK ? 0 : static_cast<int>(code));
+	resp.set_message(msg);
+	return ProtoCodec::newResponse(resp, code);
+}
+
+// 限流拒绝：429 + Retry-After
+static drogon::HttpResponsePtr rateLimited(bool protobuf, int retryAfterSec)
+{
+	static auto &rejected = Metrics::Registry::instance().counter(
+		"gateway_ratelimit_rejected_total", "Requests rejected by the gateway rate limiter");
+	rejected.inc();
+	auto resp = transResp(protobuf, "error", "Too many requests", k429TooManyRequests);
+	resp->addHeader("Retry-After", std::to_string(retryAfterSec));
+	return resp;
+}
+
+// 按 IP 限流的 key：只采信受信代理转发的客户端地址
+static std::string clientIp(const drogon::HttpRequestPtr &req)
+{
+	return RateLimiter::clientIp(req->peerAddr().toIp(), req->getHeader("X-Real-IP"), req->getHeader("X-Forwarded-For"),
+								 AppConfig::getInstance().ratelimit.trusted_proxies);
+}
+
 static bool isChannelReady(std::shared_ptr<grpc::Channel> channel)
 {
 	grpc_connectivity_state state =
@@ -25,19 +61,21 @@ std::shared_ptr<account::accountService::Stub> AccountController::FindService(co
 	ServiceInstance value;
 
 	// 1. 尝试从缓存取
+	static Metrics::CacheStats cacheStats("service_instance");
 	if (cache_.get(key, value))
 	{
 		if (value.channel && isChannelReady(value.channel))
 		{
-			LOG_INFO("[ARC] HIT key = {}, addr = {}:{}", key, value.address, value.port);
+			cacheStats.record(true);
+			LOG_INFO_SAMPLED("[ARC] HIT key = {}, addr = {}:{}", key, value.address, value.port);
 			return value.account_stub; // ✔缓存有效
 		}
 		LOG_INFO("[ARC] MISS key = {}", key);
 	}
-	// 2. 未命中缓存 → 去 Consul 查询
-	std::string host = MyAppData::instance().consulHost;
-	int port = MyAppData::instance().consulPort;
-	CloudiskConsul consul(host, port);
+	cacheStats.record(false);
+	// 2. 未命中缓存 → 去 Consul 查询（地址取当前配置快照，热更新后立即生效）
+	const ConsulConfig &consulCfg = AppConfig::getInstance().consul;
+	CloudiskConsul consul(consulCfg.host, std::atoi(consulCfg.port.c_str()));
 	value = consul.getRoundRobinInstance(key);
 
 	if (value.address.empty())
@@ -61,8 +99,11 @@ void AccountController::signup(const drogon::HttpRequestPtr &req,
 {
 	auto stub = FindService("account_srv");
 
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
 	if (!stub)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::account::Resp>(k503ServiceUnavailable, "service_unavailable"));
 		Json::Value ret;
 		ret["error"] = "service_unavailable";
 		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
@@ -75,26 +116,42 @@ void AccountController::signup(const drogon::HttpRequestPtr &req,
 	auto request = std::make_shared<::account::ReqSignup>();
 	auto response = std::make_shared<::account::Resp>();
 
-	// 获取请求参数 (支持 JSON)
-	auto jsonPtr = req->getJsonObject();
-	if (!jsonPtr)
+	// 获取请求参数 (支持 JSON / protobuf)
+	if (ProtoCodec::isProtobufRequest(req))
 	{
-		Json::Value ret;
-		ret["error"] = "invalid_json";
-		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-		resp->setStatusCode(k400BadRequest);
-		callback(resp);
-		return;
+		if (!ProtoCodec::parseRequest(req, *request))
+			return callback(ProtoCodec::newErrorResponse<::account::Resp>(k400BadRequest, "invalid_protobuf"));
 	}
-	request->set_username((*jsonPtr)["username"].asString());
-	request->set_password((*jsonPtr)["password"].asString());
-	request->set_email((*jsonPtr)["email"].asString());
+	else
+	{
+		auto jsonPtr = req->getJsonObject();
+		if (!jsonPtr)
+		{
+			Json::Value ret;
+			ret["error"] = "invalid_json";
+			auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
+			resp->setStatusCode(k400BadRequest);
+			callback(resp);
+			return;
+		}
+		request->set_username((*jsonPtr)["username"].asString());
+		request->set_password((*jsonPtr)["password"].asString());
+		request->set_email((*jsonPtr)["email"].asString());
+	}
+	static const Metrics::RpcMetrics rpcMetrics("account_srv", "Signup");
+	const auto rpcTimer = rpcMetrics.start();
 	// 发起异步调用，捕获所有 shared_ptr 以延长生命周期
 	// 注意：std::function 要求 lambda 是可复制的，因此不能捕获 unique_ptr (即使是 move)。
 	// 必须使用 shared_ptr 来管理 stub。
 	stub->async()->Signup(context.get(), request.get(), response.get(),
-						  [callback, context, request, response](::grpc::Status s)
+						  [callback, context, request, response, protobuf, rpcTimer](::grpc::Status s)
 						  {
+							  rpcTimer.finish(s.ok());
+							  if (protobuf)
+							  {
+								  callback(ProtoCodec::newRpcResponse(s, *response));
+								  return;
+							  }
 							  if (s.ok() && response->code() == 0)
 							  {
 								  Json::Value ret;
@@ -118,45 +175,91 @@ void AccountController::signup(const drogon::HttpRequestPtr &req,
 void AccountController::signin(const drogon::HttpRequestPtr &req,
 							   std::function<void(const drogon::HttpResponsePtr &)> &&callback) const
 {
-	auto stub = FindService("account_srv");
-	if (!stub)
-	{
-		Json::Value ret;
-		ret["error"] = "service_unavailable";
-		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-		resp->setStatusCode(k503ServiceUnavailable);
-		callback(resp);
-		return;
-	}
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
+	int retryAfter = 0;
+	if (!RateLimiter::instance().allow(RateLimiter::RuleId::kSigninIp, clientIp(req), retryAfter))
+		return callback(rateLimited(protobuf, retryAfter));
 
 	auto context = std::make_shared<::grpc::ClientContext>();
 	auto request = std::make_shared<::account::ReqSignin>();
 	auto response = std::make_shared<::account::Resp>();
 
-	// 获取请求参数 (支持 JSON)
-	auto jsonPtr = req->getJsonObject();
-	if (!jsonPtr)
+	// 获取请求参数 (支持 JSON / protobuf)
+	if (ProtoCodec::isProtobufRequest(req))
+	{
+		if (!ProtoCodec::parseRequest(req, *request))
+			return callback(ProtoCodec::newErrorResponse<::account::Resp>(k400BadRequest, "invalid_protobuf"));
+	}
+	else
+	{
+		auto jsonPtr = req->getJsonObject();
+		if (!jsonPtr)
+		{
+			Json::Value ret;
+			ret["error"] = "invalid_json";
+			auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
+			resp->setStatusCode(k400BadRequest);
+			callback(resp);
+			return;
+		}
+		request->set_username((*jsonPtr)["username"].asString());
+		request->set_password((*jsonPtr)["password"].asString());
+	}
+
+	// 按用户名限流，防止针对单个账号的口令爆破
+	if (!RateLimiter::instance().allow(RateLimiter::RuleId::kSigninUser, request->username(), retryAfter))
+		return callback(rateLimited(protobuf, retryAfter));
+
+	auto stub = FindService("account_srv");
+	if (!stub)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::account::Resp>(k503ServiceUnavailable, "service_unavailable"));
 		Json::Value ret;
-		ret["error"] = "invalid_json";
+		ret["error"] = "service_unavailable";
 		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-		resp->setStatusCode(k400BadRequest);
+		resp->setStatusCode(k503ServiceUnavailable);
 		callback(resp);
 		return;
 	}
-	request->set_username((*jsonPtr)["username"].asString());
-	request->set_password((*jsonPtr)["password"].asString());
+
+	static const Metrics::RpcMetrics rpcMetrics("account_srv", "Signin");
+	const auto rpcTimer = rpcMetrics.start();
 	// 发起异步调用，捕获所有 shared_ptr 以延长生命周期
 	// 注意：std::function 要求 lambda 是可复制的，因此不能捕获 unique_ptr (即使是 move)。
 	// 必须使用 shared_ptr 来管理 stub。
 	stub->async()->Signin(context.get(), request.get(), response.get(),
-						  [callback, context, request, response](::grpc::Status s)
+						  [callback, context, request, response, protobuf, rpcTimer](::grpc::Status s)
 						  {
+							  rpcTimer.finish(s.ok());
+							  if (protobuf)
+							  {
+								  callback(ProtoCodec::newRpcResponse(s, *response));
+								  return;
+							  }
 							  if (s.ok() && response->code() == 0)
 							  {
 								  Json::Value ret;
 								  ret["status"] = "ok";
-								  ret["token"] = response->message();
+								  // 用后端 token 中的身份在本地签发短期 access + refresh；后端 token 无法本地校验时原样透传
+								  JwtClaims claims;
+								  std::string accessToken, refreshToken;
+								  int64_t exp = 0;
+								  if (JwtVerifier::verify(response->message(), claims) == JwtVerifier::Result::kOk)
+								  {
+									  accessToken = TokenService::instance().issueAccess(claims.id, claims.name, exp);
+									  refreshToken = TokenService::instance().issueRefresh(claims.id, claims.name);
+								  }
+								  if (!accessToken.empty() && !refreshToken.empty())
+								  {
+									  ret["token"] = accessToken;
+									  ret["refresh_token"] = refreshToken;
+									  ret["expires_in"] = TokenService::instance().accessTtl();
+								  }
+								  else
+								  {
+									  ret["token"] = response->message();
+								  }
 								  auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
 								  callback(resp);
 								  LOG_INFO("[signin] user:{}   user registering", request->username());
@@ -173,23 +276,65 @@ void AccountController::signin(const drogon::HttpRequestPtr &req,
 							  } });
 }
 
-void AccountController::userinfo(const HttpRequestPtr &req,
-								 std::function<void(const HttpResponsePtr &)> &&callback) const
+void AccountController::refreshToken(const HttpRequestPtr &req,
+									 std::function<void(const HttpResponsePtr &)> &&callback) const
 {
-	auto stub = FindService("account_srv");
-	if (!stub)
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
+
+	// refresh token 取自 JSON 的 refresh_token 字段，或 Authorization: Bearer 头
+	std::string token;
+	if (!ProtoCodec::isProtobufRequest(req))
 	{
-		Json::Value ret;
-		ret["error"] = "service_unavailable";
-		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-		resp->setStatusCode(k503ServiceUnavailable);
-		callback(resp);
-		return;
+		auto json = req->getJsonObject();
+		if (json && json->isMember("refresh_token"))
+			token = (*json)["refresh_token"].asString();
+	}
+	if (token.empty())
+	{
+		const auto &auth = req->getHeader("Authorization");
+		if (auth.rfind("Bearer ", 0) == 0)
+			token = auth.substr(7);
 	}
+	if (token.empty())
+		return callback(transResp(protobuf, "error", "Missing refresh token", k400BadRequest));
 
-	auto context = std::make_shared<::grpc::ClientContext>();
-	auto request = std::make_shared<::account::ReqUserinfo>();
-	auto response = std::make_shared<::account::Resp>();
+	std::string accessToken, err;
+	int64_t exp = 0;
+	if (!TokenService::instance().refresh(token, accessToken, exp, err))
+	{
+		LOG_INFO("[refreshToken] rejected: {}", err);
+		return callback(transResp(protobuf, "error", err, k401Unauthorized));
+	}
+
+	if (protobuf)
+		return callback(transResp(protobuf, "ok", accessToken, k200OK));
+	Json::Value ret;
+	ret["status"] = "ok";
+	ret["token"] = accessToken;
+	ret["expires_in"] = TokenService::instance().accessTtl();
+	callback(drogon::HttpResponse::newHttpJsonResponse(ret));
+}
+
+// Userinfo 成功响应（缓存命中与回源共用）
+static drogon::HttpResponsePtr userinfoResp(bool protobuf, const std::string &message)
+{
+	if (protobuf)
+	{
+		::account::Resp resp;
+		resp.set_code(0);
+		resp.set_message(message);
+		return ProtoCodec::newResponse(resp);
+	}
+	Json::Value ret;
+	ret["status"] = "ok";
+	ret["message"] = message;
+	return drogon::HttpResponse::newHttpJsonResponse(ret);
+}
+
+void AccountController::userinfo(const HttpRequestPtr &req,
+								 std::function<void(const HttpResponsePtr &)> &&callback) const
+{
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
 
 	std::string name;
 	int userId = 0;
@@ -200,6 +345,8 @@ void AccountController::userinfo(const HttpRequestPtr &req,
 	}
 	catch (const std::exception &e)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::account::Resp>(k401Unauthorized, "missing_identity"));
 		Json::Value ret;
 		ret["error"] = "missing_identity";
 		ret["details"] = e.what();
@@ -209,22 +356,62 @@ void AccountController::userinfo(const HttpRequestPtr &req,
 		return;
 	}
 
+	// 1. 本地缓存
+	std::string cached;
+	if (UserinfoCache::instance().getLocal(userId, cached))
+		return callback(userinfoResp(protobuf, cached));
+
+	// 2. Redis 共享缓存，未命中再回源 account_srv
+	const uint64_t epoch = UserinfoCache::instance().epoch();
+	UserinfoCache::instance().getShared(userId, [this, callback, protobuf, name, userId, epoch](bool found, const std::string &message) mutable
+										{
+		if (found)
+			return callback(userinfoResp(protobuf, message));
+		fetchUserinfo(userId, name, protobuf, epoch, std::move(callback)); });
+}
+
+void AccountController::fetchUserinfo(int userId, const std::string &name, bool protobuf, uint64_t epoch,
+									  std::function<void(const HttpResponsePtr &)> &&callback) const
+{
+	auto stub = FindService("account_srv");
+	if (!stub)
+	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::account::Resp>(k503ServiceUnavailable, "service_unavailable"));
+		Json::Value ret;
+		ret["error"] = "service_unavailable";
+		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
+		resp->setStatusCode(k503ServiceUnavailable);
+		callback(resp);
+		return;
+	}
+
+	auto context = std::make_shared<::grpc::ClientContext>();
+	auto request = std::make_shared<::account::ReqUserinfo>();
+	auto response = std::make_shared<::account::Resp>();
+
 	request->set_username(name);
 	request->set_id(userId);
+	static const Metrics::RpcMetrics rpcMetrics("account_srv", "Userinfo");
+	const auto rpcTimer = rpcMetrics.start();
 	stub->async()->Userinfo(context.get(), request.get(), response.get(),
-							[callback, context, request, response](::grpc::Status s)
+							[callback, context, request, response, protobuf, epoch, rpcTimer](::grpc::Status s)
 							{
+							rpcTimer.finish(s.ok());
 							if (s.ok() && response->code() == 0)
+								UserinfoCache::instance().put(request->id(), response->message(), epoch);
+							if (protobuf)
 							{
-								Json::Value ret;
-								ret["status"] = "ok";
-								ret["message"] = response->message();
-								auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-								callback(resp);
-								LOG_INFO("[signin] user:{}   user registering", request->username());
+								callback(ProtoCodec::newRpcResponse(s, *response));
+								return;
+							}
+							if (s.ok() && response->code() == 0)
+							{
+								callback(userinfoResp(false, response->message()));
+								LOG_INFO_SAMPLED("[userinfo] user:{}   userinfo loaded", request->username());
 							}
 							else{
-								LOG_ERROR("[signin] gRPC Signin failed: {} {}", (int)s.error_code(), s.error_message());
+								LOG_ERROR("[userinfo] gRPC Userinfo failed: {} {}", (int)s.error_code(), s.error_message());
 								Json::Value ret;
 								ret["error"] = s.error_code();
 								ret["details"] = s.error_message();
@@ -237,103 +424,128 @@ void AccountController::userinfo(const HttpRequestPtr &req,
 void AccountController::sendcode(const HttpRequestPtr &req,
 								 std::function<void(const HttpResponsePtr &)> &&callback) const
 {
-	auto json = req->getJsonObject();
-	Json::Value ret;
-	if (!json)
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
+	int retryAfter = 0;
+	if (!RateLimiter::instance().allow(RateLimiter::RuleId::kSendcodeIp, clientIp(req), retryAfter))
+		return callback(rateLimited(protobuf, retryAfter));
+
+	std::string email;
+	if (ProtoCodec::isProtobufRequest(req))
 	{
-		auto resp = transError("error", "Invalid JSON", k400BadRequest);
-		return callback(resp);
+		// 复用 Reqverifycode，只取 email 字段
+		::account::Reqverifycode pb;
+		if (!ProtoCodec::parseRequest(req, pb))
+			return callback(transResp(protobuf, "error", "Invalid protobuf", k400BadRequest));
+		email = pb.email();
+	}
+	else
+	{
+		auto json = req->getJsonObject();
+		if (!json)
+		{
+			auto resp = transError("error", "Invalid JSON", k400BadRequest);
+			return callback(resp);
+		}
+		email = (*json)["email"].asString();
 	}
 
-	std::string email = (*json)["email"].asString();
 	if (email.empty())
 	{
-		auto resp = transError("error", "Email is empty", k400BadRequest);
+		auto resp = transResp(protobuf, "error", "Email is empty", k400BadRequest);
 		return callback(resp);
 	}
+	if (!RateLimiter::instance().allow(RateLimiter::RuleId::kSendcodeEmail, email, retryAfter))
+		return callback(rateLimited(protobuf, retryAfter));
 
-	std::string host = MyAppData::instance().kafkaHost;
-	int port = MyAppData::instance().kafkaPort;
-	if (!KafkaProducer::instance().init(host + ":" + std::to_string(port)))
+	// 生产者在网关启动时已建立，这里只入队；队列满说明下游堆积，直接让客户端稍后重试
+	// key 取邮箱：同一邮箱固定落在同一分区，email_srv 的去重和顺序都在分区内成立
+	static auto &rejected = Metrics::Registry::instance().counter(
+		"gateway_kafka_produce_rejected_total", "sendcode requests rejected because the producer queue was full");
+	std::string topic = "email_verify";
+	switch (KafkaProducer::instance().send(topic, email, email))
+	{
+	case KafkaProducer::SendResult::kOk:
+		break;
+	case KafkaProducer::SendResult::kQueueFull:
 	{
-		auto resp = transError("error", "Kafka producer init failed", k400BadRequest);
+		rejected.inc();
+		auto resp = transResp(protobuf, "error", "Too many pending requests, retry later", k503ServiceUnavailable);
+		resp->addHeader("Retry-After", "1");
 		return callback(resp);
 	}
-	std::string topic = "email_verify";
-	if (!KafkaProducer::instance().send(topic, email))
+	default:
 	{
-		auto resp = transError("error", "Kafka send failed", k400BadRequest);
+		auto resp = transResp(protobuf, "error", "Kafka send failed", k503ServiceUnavailable);
 		return callback(resp);
 	}
+	}
 
-	auto resp = transError("ok", "code send successfully", k200OK);
+	auto resp = transResp(protobuf, "ok", "code send successfully", k200OK);
 	callback(resp);
 }
 
 void AccountController::verifycode(const HttpRequestPtr &req,
 								   std::function<void(const HttpResponsePtr &)> &&callback) const
 {
-	auto json = req->getJsonObject();
-	if (!json)
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
+	std::string email;
+	std::string code;
+	if (ProtoCodec::isProtobufRequest(req))
 	{
-		auto resp = transError("error", "Invalid JSON", k400BadRequest);
-		callback(resp);
-		return;
+		::account::Reqverifycode pb;
+		if (!ProtoCodec::parseRequest(req, pb))
+			return callback(transResp(protobuf, "error", "Invalid protobuf", k400BadRequest));
+		email = pb.email();
+		code = pb.code();
 	}
-
-	if (!json->isMember("email") || !json->isMember("code"))
+	else
 	{
-		auto resp = transError("error", "Missing email or code field", k400BadRequest);
-		return callback(resp);
+		auto json = req->getJsonObject();
+		if (!json)
+		{
+			auto resp = transError("error", "Invalid JSON", k400BadRequest);
+			callback(resp);
+			return;
+		}
+
+		if (!json->isMember("email") || !json->isMember("code"))
+		{
+			auto resp = transError("error", "Missing email or code field", k400BadRequest);
+			return callback(resp);
+		}
+		email = (*json)["email"].asString();
+		code = (*json)["code"].asString();
 	}
-	std::string email = (*json)["email"].asString();
-	std::string code = (*json)["code"].asString();
 	if (email.empty() || code.empty())
 	{
-		auto resp = transError("error", "Email or code is empty", k400BadRequest);
+		auto resp = transResp(protobuf, "error", "Email or code is empty", k400BadRequest);
 		return callback(resp);
 	}
-	auto redisClient = app().getRedisClient();
-	if (!redisClient)
-	{
-		auto resp = transError("error", "Redis client unavailable", k500InternalServerError);
-		callback(resp);
-		return;
-	}
-	redisClient->execCommandAsync(
-		[code, callback](const drogon::nosql::RedisResult &r)
+	// 比对成功即删除，验证码只能用一次
+	GatewayRedis::instance().verifyCode(
+		email, code,
+		[callback, protobuf](GatewayRedis::VerifyResult result)
 		{
-			if (r.type() == nosql::RedisResultType::kNil)
+			switch (result)
 			{
+			case GatewayRedis::VerifyResult::kMatched:
+				callback(transResp(protobuf, "ok", "Verification code matched", k200OK));
+				return;
+			case GatewayRedis::VerifyResult::kMismatch:
+				LOG_INFO("Verification code does not match");
+				callback(transResp(protobuf, "error", "Verification code does not match", k400BadRequest));
+				return;
+			case GatewayRedis::VerifyResult::kTooManyAttempts:
+				LOG_INFO("Verification code invalidated after too many attempts");
+				callback(transResp(protobuf, "error", "Too many attempts, request a new verification code", k429TooManyRequests));
+				return;
+			case GatewayRedis::VerifyResult::kNotFound:
 				LOG_INFO("Cannot find variable associated with the key 'email'");
-				auto resp = transError("error", "Have no find email key", k400BadRequest);
-				callback(resp);
+				callback(transResp(protobuf, "error", "Have no find email key", k400BadRequest));
+				return;
+			default:
+				callback(transResp(protobuf, "error", "Redis client unavailable", k500InternalServerError));
 				return;
 			}
-			else
-			{
-				if (r.asString() == code)
-				{
-					LOG_INFO("Name is {}", r.asString());
-					auto resp = transError("ok", "Verification code matched", k200OK);
-					callback(resp);
-					return;
-				}
-				else
-				{
-					LOG_INFO("Verification code does not match");
-					auto resp = transError("error", "Verification code does not match", k400BadRequest);
-					callback(resp);
-					return;
-				}
-			}
-		},
-		[callback](const std::exception &err)
-		{
-			LOG_ERROR("something failed!!! {}", err.what());
-			auto resp = transError("error", "something failed!!!", k400BadRequest);
-			callback(resp);
-			return;
-		},
-		"get %s", email.c_str());
+		});
 }
\ No newline at end of file
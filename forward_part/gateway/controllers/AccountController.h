@@ -19,6 +19,9 @@ private:
 	const int CAPACITY;
 	mutable Cache::KArcCache<std::string, ServiceInstance> cache_;
 	std::shared_ptr<account::accountService::Stub> FindService(const std::string &key) const;
+	// Userinfo 缓存未命中时回源 account_srv，并回填缓存
+	void fetchUserinfo(int userId, const std::string &name, bool protobuf, uint64_t epoch,
+					   std::function<void(const HttpResponsePtr &)> &&callback) const;
 
 public:
 	AccountController()
@@ -29,6 +32,7 @@ public:
 	// use METHOD_ADD to add your custom processing function here;
 	ADD_METHOD_TO(AccountController::signup, "/user/signup", Post);
 	ADD_METHOD_TO(AccountController::signin, "/user/signin", Post);
+	ADD_METHOD_TO(AccountController::refreshToken, "/user/token/refresh", Post);
 	ADD_METHOD_TO(AccountController::sendcode, "/user/sendcode", Post);
 	ADD_METHOD_TO(AccountController::verifycode, "/user/code", Post);
 	ADD_METHOD_TO(AccountController::userinfo, "/user/info", Get, "jwt_decode");
@@ -39,6 +43,8 @@ public:
 				std::function<void(const HttpResponsePtr &)> &&callback);
 	void signin(const HttpRequestPtr &req,
 				std::function<void(const HttpResponsePtr &)> &&callback) const;
+	void refreshToken(const HttpRequestPtr &req,
+					  std::function<void(const HttpResponsePtr &)> &&callback) const;
 	void userinfo(const HttpRequestPtr &req,
 				  std::function<void(const HttpResponsePtr &)> &&callback) const;
 	void sendcode(const HttpRequestPtr &req,
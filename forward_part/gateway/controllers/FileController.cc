@@ -1,5 +1,7 @@
 #include "FileController.h"
 #include "Hash.h"
+#include "ProtoCodec.h"
+#include "../metrics/Metrics.h"
 
 static bool isChannelReady(std::shared_ptr<grpc::Channel> channel)
 {
@@ -35,19 +37,21 @@ std::shared_ptr<file::fileService::Stub> FileController::FindService(const std::
 	ServiceInstance value;
 
 	// 1. 尝试从缓存取
+	static Metrics::CacheStats cacheStats("service_instance");
 	if (cache_.get(key, value))
 	{
 		if (value.channel && isChannelReady(value.channel))
 		{
-			LOG_INFO("[ARC] HIT key = {}, addr = {}:{}", key, value.address, value.port);
+			cacheStats.record(true);
+			LOG_INFO_SAMPLED("[ARC] HIT key = {}, addr = {}:{}", key, value.address, value.port);
 			return value.file_stub; // ✔缓存有效
 		}
 		LOG_INFO("[ARC] MISS key = {}", key);
 	}
-	// 2. 未命中缓存 → 去 Consul 查询
-	std::string host = MyAppData::instance().consulHost;
-	int port = MyAppData::instance().consulPort;
-	CloudiskConsul consul(host, port);
+	cacheStats.record(false);
+	// 2. 未命中缓存 → 去 Consul 查询（地址取当前配置快照，热更新后立即生效）
+	const ConsulConfig &consulCfg = AppConfig::getInstance().consul;
+	CloudiskConsul consul(consulCfg.host, std::atoi(consulCfg.port.c_str()));
 	value = consul.getRoundRobinInstance(key);
 
 	if (value.address.empty())
@@ -89,8 +93,11 @@ void FileController::filequeryinfo(const HttpRequestPtr &req,
 								   std::function<void(const HttpResponsePtr &)> &&callback) const
 {
 	auto stub = FindService("file_srv");
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
 	if (!stub)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::file::Resp>(k503ServiceUnavailable, "service_unavailable"));
 		Json::Value ret;
 		ret["error"] = "service_unavailable";
 		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
@@ -124,9 +131,17 @@ void FileController::filequeryinfo(const HttpRequestPtr &req,
 	}
 	request->set_userid(std::to_string(userId));
 	request->set_username(name);
+	static const Metrics::RpcMetrics rpcMetrics("file_srv", "filequeryinfo");
+	const auto rpcTimer = rpcMetrics.start();
 	stub->async()->filequeryinfo(context.get(), request.get(), response.get(),
-								 [context, request, response, callback](::grpc::Status status)
+								 [context, request, response, callback, protobuf, rpcTimer](::grpc::Status status)
 								 {
+									 rpcTimer.finish(status.ok());
+									 if (protobuf)
+									 {
+										 callback(ProtoCodec::newRpcResponse(status, *response));
+										 return;
+									 }
 									 if (status.ok() && response->code() == 0)
 									 {
 										 Json::Value ret;
@@ -142,7 +157,7 @@ void FileController::filequeryinfo(const HttpRequestPtr &req,
 											 fileJson["filehash"] = fileinfo.file_hash();
 											 ret["filelist"].append(fileJson);
 										 }
-										 LOG_INFO("[filequeryinfo] user:{}   find {} files", request->username(), response->files_size());
+										 LOG_INFO_SAMPLED("[filequeryinfo] user:{}   find {} files", request->username(), response->files_size());
 										 auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
 										 resp->setStatusCode(k200OK);
 										 callback(resp);
@@ -163,8 +178,11 @@ void FileController::filedowm(const HttpRequestPtr &req,
 							  std::function<void(const HttpResponsePtr &)> &&callback) const
 {
 	auto stub = FindService("file_srv");
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
 	if (!stub)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::file::Resp>(k503ServiceUnavailable, "service_unavailable"));
 		Json::Value ret;
 		ret["error"] = "service_unavailable";
 
@@ -187,25 +205,43 @@ void FileController::filedowm(const HttpRequestPtr &req,
 		return;
 	}
 
-	auto jsonPtr = req->getJsonObject();
-	if (!jsonPtr)
+	if (ProtoCodec::isProtobufRequest(req))
 	{
-		Json::Value ret;
-		ret["error"] = "invalid_json";
-		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-		resp->setStatusCode(k400BadRequest);
-		callback(resp);
-		LOG_ERROR("[filedowm] invalid JSON in request");
-		return;
+		if (!ProtoCodec::parseRequest(req, *request))
+			return callback(ProtoCodec::newErrorResponse<::file::Resp>(k400BadRequest, "invalid_protobuf"));
+	}
+	else
+	{
+		auto jsonPtr = req->getJsonObject();
+		if (!jsonPtr)
+		{
+			Json::Value ret;
+			ret["error"] = "invalid_json";
+			auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
+			resp->setStatusCode(k400BadRequest);
+			callback(resp);
+			LOG_ERROR("[filedowm] invalid JSON in request");
+			return;
+		}
+		request->set_filename((*jsonPtr)["filename"].asString());
+		request->set_filehash((*jsonPtr)["filehash"].asString());
+		request->set_file_size((*jsonPtr)["file_size"].asInt64());
 	}
-	request->set_filename((*jsonPtr)["filename"].asString());
-	request->set_filehash((*jsonPtr)["filehash"].asString());
+	// 身份字段一律以 JWT 为准，不信任客户端传入的值
 	request->set_userid(std::to_string(userId));
 	request->set_username(name);
-	request->set_file_size((*jsonPtr)["file_size"].asInt64());
+	static const Metrics::RpcMetrics rpcMetrics("file_srv", "filedowm");
+	const auto rpcTimer = rpcMetrics.start();
 	stub->async()->filedowm(context.get(), request.get(), response.get(),
-							[context, request, response, callback](::grpc::Status status)
+							[context, request, response, callback, protobuf, rpcTimer](::grpc::Status status)
 							{
+								rpcTimer.finish(status.ok());
+								// protobuf 客户端直接拿 Resp.message 里的签名 URL，不走 302
+								if (protobuf)
+								{
+									callback(ProtoCodec::newRpcResponse(status, *response));
+									return;
+								}
 								if (!status.ok() || response == nullptr)
 								{
 									LOG_INFO("[filedowm] user:{} find {} download file failed",
@@ -226,8 +262,8 @@ void FileController::filedowm(const HttpRequestPtr &req,
 								resp->setStatusCode(drogon::k302Found);
 								resp->addHeader("Location", downloadURL);
 								callback(resp);
-								LOG_INFO("[filedowm] user:{} find {} download file oss signed url {}",
-										 request->username(), request->filename(), downloadURL);
+								LOG_INFO_SAMPLED("[filedowm] user:{} find {} download file oss signed url {}",
+												 request->username(), request->filename(), downloadURL);
 							});
 }
 
@@ -235,8 +271,11 @@ void FileController::LoadFile(const HttpRequestPtr &req,
 							  std::function<void(const HttpResponsePtr &)> &&callback) const
 {
 	auto stub = FindService("file_srv");
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
 	if (!stub)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::file::Resp>(k503ServiceUnavailable, "service_unavailable"));
 		Json::Value ret;
 		ret["error"] = "service_unavailable";
 		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
@@ -257,32 +296,50 @@ void FileController::LoadFile(const HttpRequestPtr &req,
 		callback(resp);
 		return;
 	}
-	auto jsonPtr = req->getJsonObject();
-	if (!jsonPtr)
+	if (ProtoCodec::isProtobufRequest(req))
 	{
-		Json::Value ret;
-		ret["error"] = "invalid_json";
-		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-		resp->setStatusCode(k400BadRequest);
-		callback(resp);
-		return;
+		// content 为 bytes，直接落在请求消息里，无需 base64/JSON 转义
+		if (!ProtoCodec::parseRequest(req, *request))
+			return callback(ProtoCodec::newErrorResponse<::file::Resp>(k400BadRequest, "invalid_protobuf"));
 	}
+	else
+	{
+		auto jsonPtr = req->getJsonObject();
+		if (!jsonPtr)
+		{
+			Json::Value ret;
+			ret["error"] = "invalid_json";
+			auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
+			resp->setStatusCode(k400BadRequest);
+			callback(resp);
+			return;
+		}
 
-	request->set_filename((*jsonPtr)["filename"].asString());
-	request->set_content((*jsonPtr)["content"].asString());
+		request->set_filename((*jsonPtr)["filename"].asString());
+		request->set_content((*jsonPtr)["content"].asString());
+	}
 	request->set_userid(std::to_string(userId));
 	request->set_username(name);
-	request->set_file_size((*jsonPtr)["content"].asString().size());
-	request->set_file_hash(Hash((*jsonPtr)["filename"].asString(), (*jsonPtr)["content"].asString()).sha256());
+	// 大小和哈希由网关根据实际内容计算
+	request->set_file_size(request->content().size());
+	request->set_file_hash(Hash(request->filename(), request->content()).sha256());
+	static const Metrics::RpcMetrics rpcMetrics("file_srv", "LoadFile");
+	const auto rpcTimer = rpcMetrics.start();
 	stub->async()->LoadFile(context.get(), request.get(), response.get(),
-							[context, request, response, callback](::grpc::Status status)
+							[context, request, response, callback, protobuf, rpcTimer](::grpc::Status status)
 							{
+								rpcTimer.finish(status.ok());
+								if (protobuf)
+								{
+									callback(ProtoCodec::newRpcResponse(status, *response));
+									return;
+								}
 								if (status.ok() && response->code() == 0)
 								{
 									Json::Value ret;
 									ret["status"] = response->code();
 									ret["message"] = response->message();
-									LOG_INFO("[LoadFile] user:{}   find {} Load ", request->username(), request->filename());
+									LOG_INFO_SAMPLED("[LoadFile] user:{}   find {} Load ", request->username(), request->filename());
 									auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
 									resp->setStatusCode(k200OK);
 									callback(resp);
@@ -304,8 +361,11 @@ void FileController::Showfile(const HttpRequestPtr &req,
 							  std::function<void(const HttpResponsePtr &)> &&callback) const
 {
 	auto stub = FindService("file_srv");
+	const bool protobuf = ProtoCodec::wantsProtobuf(req);
 	if (!stub)
 	{
+		if (protobuf)
+			return callback(ProtoCodec::newErrorResponse<::file::Resp>(k503ServiceUnavailable, "service_unavailable"));
 		Json::Value ret;
 		ret["error"] = "service_unavailable";
 		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
@@ -326,25 +386,41 @@ void FileController::Showfile(const HttpRequestPtr &req,
 		callback(resp);
 		return;
 	}
-	auto jsonPtr = req->getJsonObject();
-	if (!jsonPtr)
+	if (ProtoCodec::isProtobufRequest(req))
 	{
-		Json::Value ret;
-		ret["error"] = "invalid_json";
-		auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
-		resp->setStatusCode(k400BadRequest);
-		LOG_ERROR("[Showfile] invalid JSON in request");
-		callback(resp);
-		return;
+		if (!ProtoCodec::parseRequest(req, *request))
+			return callback(ProtoCodec::newErrorResponse<::file::Resp>(k400BadRequest, "invalid_protobuf"));
+	}
+	else
+	{
+		auto jsonPtr = req->getJsonObject();
+		if (!jsonPtr)
+		{
+			Json::Value ret;
+			ret["error"] = "invalid_json";
+			auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
+			resp->setStatusCode(k400BadRequest);
+			LOG_ERROR("[Showfile] invalid JSON in request");
+			callback(resp);
+			return;
+		}
+		request->set_filename((*jsonPtr)["filename"].asString());
+		request->set_filehash((*jsonPtr)["filehash"].asString());
+		request->set_file_size((*jsonPtr)["file_size"].asInt64());
 	}
-	request->set_filename((*jsonPtr)["filename"].asString());
-	request->set_filehash((*jsonPtr)["filehash"].asString());
 	request->set_userid(std::to_string(userId));
 	request->set_username(name);
-	request->set_file_size((*jsonPtr)["file_size"].asInt64());
+	static const Metrics::RpcMetrics rpcMetrics("file_srv", "Showfile");
+	const auto rpcTimer = rpcMetrics.start();
 	stub->async()->Showfile(context.get(), request.get(), response.get(),
-							[context, request, response, callback](::grpc::Status status)
+							[context, request, response, callback, protobuf, rpcTimer](::grpc::Status status)
 							{
+								rpcTimer.finish(status.ok());
+								if (protobuf)
+								{
+									callback(ProtoCodec::newRpcResponse(status, *response));
+									return;
+								}
 								if (!status.ok() || response == nullptr)
 								{
 									LOG_INFO("[Showfile] user:{} find {} show failed",
@@ -369,7 +445,7 @@ void FileController::Showfile(const HttpRequestPtr &req,
 								resp->setStatusCode(drogon::k303SeeOther);
 								resp->addHeader("Location", previewURL);
 								callback(resp);
-								LOG_INFO("[Showfile] user:{} find {} show file oss signed url url{}",
-										 request->username(), request->filename(), previewURL);
+								LOG_INFO_SAMPLED("[Showfile] user:{} find {} show file oss signed url url{}",
+												 request->username(), request->filename(), previewURL);
 							});
 }
\ No newline at end of file
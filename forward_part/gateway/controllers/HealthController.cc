@@ -1,4 +1,6 @@
 #include "HealthController.h"
+#include "../bootstrap/Bootstrap.h"
+#include "../bootstrap/HealthProbe.h"
 
 void HealthController::health(const drogon::HttpRequestPtr &req,
 							  std::function<void(const drogon::HttpResponsePtr &)> &&callback)
@@ -7,4 +9,19 @@ void HealthController::health(const drogon::HttpRequestPtr &req,
 	resp->setStatusCode(drogon::k200OK);
 	resp->setBody("OK");
 	callback(resp);
-}
\ No newline at end of file
+}
+
+void HealthController::ready(const drogon::HttpRequestPtr &req,
+							 std::function<void(const drogon::HttpResponsePtr &)> &&callback)
+{
+	// 两部分都只读原子缓存，不做任何 IO
+	auto &bootstrap = Bootstrap::instance();
+	auto &probe = HealthProbe::instance();
+	Json::Value body = bootstrap.status();
+	body["probes"] = probe.status();
+	const bool ready = bootstrap.ready() && probe.ready();
+	body["ready"] = ready;
+	auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+	resp->setStatusCode(ready ? drogon::k200OK : drogon::k503ServiceUnavailable);
+	callback(resp);
+}
@@ -11,7 +11,12 @@ public:
 	METHOD_LIST_BEGIN
 	// use METHOD_ADD to add your custom processing function here;
 	ADD_METHOD_TO(HealthController::health, "/health", Get);
+	ADD_METHOD_TO(HealthController::ready, "/ready", Get);
 	METHOD_LIST_END
+	// 存活：进程在、事件循环在转
 	void health(const drogon::HttpRequestPtr &req,
 				std::function<void(const drogon::HttpResponsePtr &)> &&callback);
+	// 就绪：关键依赖已初始化且后台探测正常（Redis、后端通道、事件循环延迟），否则返回 503 和各项状态
+	void ready(const drogon::HttpRequestPtr &req,
+			   std::function<void(const drogon::HttpResponsePtr &)> &&callback);
 };
@@ -0,0 +1,12 @@
+#include "MetricsController.h"
+#include "../metrics/Metrics.h"
+
+void MetricsController::metrics(const drogon::HttpRequestPtr &req,
+								std::function<void(const drogon::HttpResponsePtr &)> &&callback)
+{
+	auto resp = drogon::HttpResponse::newHttpResponse();
+	resp->setStatusCode(drogon::k200OK);
+	resp->setContentTypeCodeAndCustomString(drogon::CT_CUSTOM, "text/plain; version=0.0.4");
+	resp->setBody(Metrics::Registry::instance().render());
+	callback(resp);
+}
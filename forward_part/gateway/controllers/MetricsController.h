@@ -0,0 +1,17 @@
+#pragma once
+
+#include <drogon/HttpController.h>
+#include <drogon/HttpResponse.h>
+#include <drogon/HttpTypes.h>
+using namespace drogon;
+
+class MetricsController : public drogon::HttpController<MetricsController>
+{
+public:
+	METHOD_LIST_BEGIN
+	// use METHOD_ADD to add your custom processing function here;
+	ADD_METHOD_TO(MetricsController::metrics, "/metrics", Get);
+	METHOD_LIST_END
+	void metrics(const drogon::HttpRequestPtr &req,
+				 std::function<void(const drogon::HttpResponsePtr &)> &&callback);
+};
@@ -0,0 +1,40 @@
+#include "ProtoCodec.h"
+
+namespace ProtoCodec
+{
+	const char *const kContentType = "application/x-protobuf";
+
+	bool isProtobufRequest(const drogon::HttpRequestPtr &req)
+	{
+		// 允许带参数，例如 application/x-protobuf; proto=account.ReqSignin
+		const auto &ct = req->getHeader("content-type");
+		return ct.rfind(kContentType, 0) == 0;
+	}
+
+	bool wantsProtobuf(const drogon::HttpRequestPtr &req)
+	{
+		if (isProtobufRequest(req))
+			return true;
+		const auto &accept = req->getHeader("accept");
+		return accept.find(kContentType) != std::string::npos;
+	}
+
+	bool parseRequest(const drogon::HttpRequestPtr &req, google::protobuf::MessageLite &msg)
+	{
+		auto body = req->body();
+		return msg.ParseFromArray(body.data(), static_cast<int>(body.size()));
+	}
+
+	drogon::HttpResponsePtr newResponse(const google::protobuf::MessageLite &msg,
+										drogon::HttpStatusCode status)
+	{
+		std::string body;
+		msg.SerializeToString(&body);
+
+		auto resp = drogon::HttpResponse::newHttpResponse();
+		resp->setStatusCode(status);
+		resp->setContentTypeCodeAndCustomString(drogon::CT_CUSTOM, kContentType);
+		resp->setBody(std::move(body));
+		return resp;
+	}
+}
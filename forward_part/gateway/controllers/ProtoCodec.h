@@ -0,0 +1,52 @@
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <google/protobuf/message_lite.h>
+#include <grpcpp/support/status.h>
+#include <string>
+
+// application/x-protobuf 内容协商
+// 自有客户端（同步守护进程、CLI）直接收发 proto/*.proto 中的消息，
+// 网关把请求体解析成 gRPC 请求消息、把 gRPC 响应消息原样序列化回去，省掉 JSON 转码
+namespace ProtoCodec
+{
+	extern const char *const kContentType;
+
+	// 请求体是否为 protobuf（Content-Type: application/x-protobuf）
+	bool isProtobufRequest(const drogon::HttpRequestPtr &req);
+
+	// 客户端是否希望拿到 protobuf 响应（Accept 声明，或请求体本身就是 protobuf）
+	bool wantsProtobuf(const drogon::HttpRequestPtr &req);
+
+	// 把请求体解析到 msg，失败返回 false
+	bool parseRequest(const drogon::HttpRequestPtr &req, google::protobuf::MessageLite &msg);
+
+	// 把 msg 序列化为 HTTP 响应
+	drogon::HttpResponsePtr newResponse(const google::protobuf::MessageLite &msg,
+										drogon::HttpStatusCode status = drogon::k200OK);
+
+	// 网关自身产生的错误：用对应服务的 Resp 类型（都带 code/message）返回
+	template <typename RespT>
+	drogon::HttpResponsePtr newErrorResponse(drogon::HttpStatusCode status, const std::string &message)
+	{
+		RespT resp;
+		resp.set_code(static_cast<int>(status));
+		resp.set_message(message);
+		return newResponse(resp, status);
+	}
+
+	// gRPC 调用结果：传输层失败转成 Resp，成功则把后端响应原样透传
+	template <typename RespT>
+	drogon::HttpResponsePtr newRpcResponse(const ::grpc::Status &s, const RespT &resp, int successCode = 0)
+	{
+		if (!s.ok())
+		{
+			RespT err;
+			err.set_code(static_cast<int>(s.error_code()));
+			err.set_message(s.error_message());
+			return newResponse(err, drogon::k500InternalServerError);
+		}
+		return newResponse(resp, resp.code() == successCode ? drogon::k200OK : drogon::k500InternalServerError);
+	}
+}
@@ -5,6 +5,7 @@
  */
 
 #include "jwt_decode.h"
+#include "../metrics/Metrics.h"
 
 using namespace drogon;
 
@@ -12,31 +13,83 @@ void jwt_decode::doFilter(const HttpRequestPtr &req,
 						  FilterCallback &&fcb,
 						  FilterChainCallback &&fccb)
 {
-    auto auth = req->getHeader("Authorization");
+    const auto &auth = req->getHeader("Authorization");
     if (auth.empty() || auth.rfind("Bearer ", 0) != 0) {
         auto res = HttpResponse::newHttpResponse();
         res->setStatusCode(k401Unauthorized);
         return fcb(res);
     }
 
-    std::string token = auth.substr(7);
-    std::string signingKey = MyAppData::instance().SigningKey;
+    std::string_view token(auth);
+    token.remove_prefix(7);
+
+    // 同一 token 在有效期内重复出现时直接复用已验证的声明
+    static Metrics::CacheStats cacheStats("jwt");
+    const uint64_t cacheGeneration = JwtCache::instance().generation();
+    JwtClaims claims;
+    const bool cached = JwtCache::instance().get(token, claims);
+    cacheStats.record(cached);
+    if (cached) {
+        req->getAttributes()->insert("ID", claims.id);
+        req->getAttributes()->insert("Name", claims.name);
+        return fccb();
+    }
+
+    // 快速路径：预计算 HMAC pad + 零拷贝解析，只处理本系统签发的 HS256 token
+    switch (JwtVerifier::verify(token, claims)) {
+    case JwtVerifier::Result::kOk:
+        if (claims.typ == "refresh") {
+            // refresh token 只能用于 /user/token/refresh，不能访问业务接口
+            auto res = HttpResponse::newHttpResponse();
+            res->setStatusCode(k401Unauthorized);
+            res->setBody("refresh token not accepted");
+            return fcb(res);
+        }
+        JwtCache::instance().put(token, claims, cacheGeneration);
+        req->getAttributes()->insert("ID", claims.id);
+        req->getAttributes()->insert("Name", claims.name);
+		LOG_INFO_SAMPLED("[doFilter]jwt decode success");
+        return fccb();
+    case JwtVerifier::Result::kInvalid:
+    case JwtVerifier::Result::kExpired: {
+        auto res = HttpResponse::newHttpResponse();
+        res->setStatusCode(k401Unauthorized);
+        res->setBody("invalid token");
+		LOG_ERROR("[doFilter]jwt decode error");
+        return fcb(res);
+    }
+    case JwtVerifier::Result::kUnsupported:
+        break; // 回退到 jwt-cpp 完整校验
+    }
+
+    // 不可变配置快照中的密钥，热更新时整份替换，引用在本次请求内始终有效
+    const std::string &signingKey = AppConfig::getInstance().jwt.secret;
 
     try {
         // 默认 decode() 会使用 picojson traits
-        auto decoded = jwt::decode(token);
+        auto decoded = jwt::decode(std::string(token));
 
         jwt::verify()  // 默认 verify() 也使用 picojson traits
             .allow_algorithm(jwt::algorithm::hs256{signingKey})
             .with_issuer("Signin")
             .verify(decoded);
 
+        if (decoded.has_payload_claim("typ") &&
+            decoded.get_payload_claim("typ").as_string() == "refresh")
+            throw std::runtime_error("refresh token not accepted");
+
         // 通过 as_integer() 获取 ID
-        int id = decoded.get_payload_claim("ID").as_integer();
-		std::string name = decoded.get_payload_claim("Name").as_string();
-        req->getAttributes()->insert("ID", id);
-		req->getAttributes()->insert("Name", name);
-		LOG_INFO("[doFilter]jwt decode success");
+        claims.id = static_cast<int>(decoded.get_payload_claim("ID").as_integer());
+        claims.name = decoded.get_payload_claim("Name").as_string();
+        if (decoded.has_expires_at()) {
+            claims.exp = std::chrono::duration_cast<std::chrono::seconds>(
+                             decoded.get_expires_at().time_since_epoch())
+                             .count();
+            JwtCache::instance().put(token, claims, cacheGeneration);
+        }
+        req->getAttributes()->insert("ID", claims.id);
+        req->getAttributes()->insert("Name", claims.name);
+		LOG_INFO_SAMPLED("[doFilter]jwt decode success");
         fccb();
     } catch (const std::exception& e) {
         auto res = HttpResponse::newHttpResponse();
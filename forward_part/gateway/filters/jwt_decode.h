@@ -11,7 +11,9 @@
 #include <nlohmann/json.hpp>
 #include <jwt-cpp/jwt.h>
 #include <jwt-cpp/traits/nlohmann-json/traits.h>
-#include "../MyAppData.h"
+#include "../../internal/internal.h"
+#include "../auth/JwtCache.h"
+#include "../auth/JwtVerifier.h"
 #include "../../logs/Logger.h"
 using namespace drogon;
 
@@ -2,21 +2,107 @@
 #include "../internal/internal.h"
 #include "ConsulRegister.h"
 #include "MyAppData.h"
+#include "bootstrap/Bootstrap.h"
+#include "auth/JwtCache.h"
+#include "auth/JwtVerifier.h"
+#include "auth/TokenService.h"
+#include "cache/UserinfoCache.h"
+#include "../../other_srv/email_srv/KafkaProducer.h"
+#include "metrics/Metrics.h"
+#include "metrics/RequestMetrics.h"
+#include "ratelimit/RateLimiter.h"
+#include "redis/GatewayRedis.h"
+
+static void applyRateLimitRules(const RateLimitConfig &rl)
+{
+	auto setRule = [](RateLimiter::RuleId id, const char *name, const RateLimitRuleConfig &rule)
+	{ RateLimiter::instance().setRule(id, {name, rule.per_minute, rule.burst}); };
+	setRule(RateLimiter::RuleId::kSendcodeIp, "sendcode_ip", rl.sendcode_ip);
+	setRule(RateLimiter::RuleId::kSendcodeEmail, "sendcode_email", rl.sendcode_email);
+	setRule(RateLimiter::RuleId::kSigninIp, "signin_ip", rl.signin_ip);
+	setRule(RateLimiter::RuleId::kSigninUser, "signin_user", rl.signin_user);
+}
+
+static bool sameRule(const RateLimitRuleConfig &a, const RateLimitRuleConfig &b)
+{
+	return a.per_minute == b.per_minute && a.burst == b.burst;
+}
+
+// Nacos 推送新快照后在回调线程执行：只重建真正变了的组件，请求线程继续无锁读取新快照
+static void onConfigChanged(const AppConfig &prev, const AppConfig &next)
+{
+	if (next.jwt.secret != prev.jwt.secret)
+	{
+		JwtVerifier::setSigningKey(next.jwt.secret);
+		// 旧密钥（可能已泄露）签发的 token 不能再凭缓存通过，新密钥生效后再清
+		JwtCache::instance().clear();
+		LOG_INFO("[config] jwt signing key rotated");
+	}
+	TokenService::instance().setTtl(next.jwt.access_ttl_sec, next.jwt.refresh_ttl_sec);
+
+	if (next.redis.host != prev.redis.host || next.redis.port != prev.redis.port ||
+		next.redis.connections_per_thread != prev.redis.connections_per_thread)
+	{
+		// 新客户端替换后，正在执行的命令继续持有旧客户端直到回调返回
+		GatewayRedis::instance().init(next.redis.host, std::atoi(next.redis.port.c_str()),
+									  next.redis.connections_per_thread, drogon::app().getThreadNum());
+		UserinfoCache::instance().start(next.cache.userinfo_local_ttl_sec, next.cache.userinfo_redis_ttl_sec);
+	}
+	else
+	{
+		UserinfoCache::instance().setTtl(next.cache.userinfo_local_ttl_sec, next.cache.userinfo_redis_ttl_sec);
+	}
+
+	const KafkaConfig &pk = prev.kafka, &nk = next.kafka;
+	if (nk.host != pk.host || nk.port != pk.port || nk.linger_ms != pk.linger_ms ||
+		nk.batch_num_messages != pk.batch_num_messages || nk.queue_max_messages != pk.queue_max_messages ||
+		nk.compression != pk.compression)
+	{
+		if (!KafkaProducer::instance().restart(nk.host + ":" + nk.port, Bootstrap::kafkaOptions(nk)))
+			LOG_ERROR("[config] kafka producer restart failed, keep previous producer");
+	}
+
+	const RateLimitConfig &pr = prev.ratelimit, &nr = next.ratelimit;
+	if (!sameRule(pr.sendcode_ip, nr.sendcode_ip) || !sameRule(pr.sendcode_email, nr.sendcode_email) ||
+		!sameRule(pr.signin_ip, nr.signin_ip) || !sameRule(pr.signin_user, nr.signin_user))
+		applyRateLimitRules(nr);
+	if (nr.sync_interval_ms != pr.sync_interval_ms)
+		RateLimiter::instance().start(nr.sync_interval_ms);
+
+	LOG_INFO("[config] new snapshot applied");
+}
+
 int main()
 {
+	// 有本地快照时立即返回，Nacos 在后台连接
+	if (!InitAppConfig())
+	{
+		LOG_ERROR("[config] no local snapshot and Nacos unavailable, cannot start");
+		return 1;
+	}
+	Bootstrap::instance().markReady(Bootstrap::Component::kConfig);
 	// 获取ip和port
-	InitAppConfig();
-	auto &cfg = AppConfig::getInstance();
+	// 启动时的快照：快照不可变且不会被释放，下面的引用在整个进程内有效
+	const AppConfig &cfg = AppConfig::getInstance();
 	std::string host = cfg.consul.gateway_srv.host;
 	int port = GetFreePort();
-	std::string SigningKey = cfg.jwt.secret;
 	std::string consulHost = cfg.consul.host;
 	int consulPort = std::atoi(cfg.consul.port.c_str());
 	std::string kafkaHost = cfg.kafka.host;
 	int kafkaPort = std::atoi(cfg.kafka.port.c_str());
-	std::string redisHost = cfg.redis.host;
-	int redisPort = std::atoi(cfg.redis.port.c_str());
-	drogon::app().createRedisClient(redisHost, redisPort);
+
+	// Kafka 生产者在启动时（Bootstrap 中）建立一次，请求路径只入队
+	KafkaProducer::instance().setDeliveryObserver([](const std::string &topic, RdKafka::ErrorCode err, int64_t latencyUs)
+												  {
+		auto &reg = Metrics::Registry::instance();
+		const bool ok = err == RdKafka::ERR_NO_ERROR;
+		reg.histogram("gateway_kafka_delivery_seconds", "Kafka enqueue-to-ack latency",
+					  "topic=\"" + topic + "\",result=\"" + (ok ? "ok" : "error") + "\"")
+			.observe(latencyUs / 1e6);
+		if (!ok)
+			reg.counter("gateway_kafka_delivery_errors_total", "Kafka delivery failures by error code",
+						"topic=\"" + topic + "\",code=\"" + std::to_string(static_cast<int>(err)) + "\"")
+				.inc(); });
 	std::string serviceName = "gateway_srv";
 	std::string serviceId = serviceName + std::to_string(port);
 	ConsulRegister consulRegister(
@@ -26,19 +112,29 @@ int main()
 		serviceId,
 		host,
 		port);
-	// 启动 Drogon HTTP 服务
+	// 限流规则
+	applyRateLimitRules(cfg.ratelimit);
+
+	// 启动 Drogon HTTP 服务：端口立即监听，依赖在事件循环起来后并行初始化，/ready 反映进度
 	drogon::app().addListener(host, port);
+	Metrics::installRequestMetrics();
 
-	// 启动前注册到 Consul
 	drogon::app().registerBeginningAdvice([&]()
 										  { 
-											MyAppData::instance().consulHost = consulHost;
-											MyAppData::instance().consulPort = consulPort;
 											MyAppData::instance().kafkaHost = kafkaHost;
 											MyAppData::instance().kafkaPort = kafkaPort;
-											MyAppData::instance().SigningKey = SigningKey;
-											consulRegister.registerService(); });
+											JwtVerifier::setSigningKey(cfg.jwt.secret);
+											TokenService::instance().setTtl(cfg.jwt.access_ttl_sec, cfg.jwt.refresh_ttl_sec);
+											RateLimiter::instance().start(cfg.ratelimit.sync_interval_ms);
+											// Redis / Kafka / Consul 注册 / gRPC 通道预热并行进行
+											Bootstrap::instance().start(cfg, consulRegister);
+											// 组件按启动快照就绪后再接收热更新；启动期间已有推送时在订阅内补一次
+											SubscribeConfig(onConfigChanged, &cfg);
+										  });
 	LOG_INFO("[drogon]Server started:{}:{} ", host, port);
 	drogon::app().run();
+	Bootstrap::instance().stop();
+	KafkaProducer::instance().stop();
+	GlobalLogger::shutdown();
 	return 0;
 }
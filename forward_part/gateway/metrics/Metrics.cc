@@ -0,0 +1,177 @@
+#include "Metrics.h"
+#include "../../../other_srv/email_srv/metricsformat.h"
+#include <algorithm>
+
+namespace Metrics
+{
+	Histogram::Histogram(std::vector<double> bounds)
+		: bounds_(std::move(bounds)),
+		  linesPerShard_((bounds_.size() + 2 + 7) / 8),
+		  sumCell_(bounds_.size() + 1),
+		  lines_(new Line[kShards * linesPerShard_])
+	{
+		for (size_t i = 0; i < kShards * linesPerShard_; ++i)
+		{
+			for (auto &c : lines_[i].cells)
+				c.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void Histogram::observe(double v)
+	{
+		const size_t shard = threadShard();
+		size_t idx = std::lower_bound(bounds_.begin(), bounds_.end(), v) - bounds_.begin();
+		cell(shard, idx).fetch_add(1, std::memory_order_relaxed);
+		if (v > 0)
+			cell(shard, sumCell_).fetch_add(static_cast<uint64_t>(v * 1e6), std::memory_order_relaxed);
+	}
+
+	std::vector<uint64_t> Histogram::buckets() const
+	{
+		std::vector<uint64_t> out(bounds_.size() + 1, 0);
+		for (size_t shard = 0; shard < kShards; ++shard)
+		{
+			for (size_t i = 0; i < out.size(); ++i)
+				out[i] += cell(shard, i).load(std::memory_order_relaxed);
+		}
+		return out;
+	}
+
+	double Histogram::sum() const
+	{
+		uint64_t micros = 0;
+		for (size_t shard = 0; shard < kShards; ++shard)
+			micros += cell(shard, sumCell_).load(std::memory_order_relaxed);
+		return micros / 1e6;
+	}
+
+	uint64_t Histogram::count() const
+	{
+		uint64_t n = 0;
+		for (uint64_t b : buckets())
+			n += b;
+		return n;
+	}
+
+	const std::vector<double> &latencyBuckets()
+	{
+		static const std::vector<double> bounds = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+												   0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+		return bounds;
+	}
+
+	Registry &Registry::instance()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	Registry::Family &Registry::family(const std::string &name, Type type, const std::string &help)
+	{
+		auto it = families_.find(name);
+		if (it == families_.end())
+			it = families_.emplace(name, Family{type, help, {}, {}, {}}).first;
+		return it->second;
+	}
+
+	Counter &Registry::counter(const std::string &name, const std::string &help, const std::string &labels)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto &slot = family(name, Type::kCounter, help).counters[labels];
+		if (!slot)
+			slot = std::make_unique<Counter>();
+		return *slot;
+	}
+
+	Gauge &Registry::gauge(const std::string &name, const std::string &help, const std::string &labels)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto &slot = family(name, Type::kGauge, help).gauges[labels];
+		if (!slot)
+			slot = std::make_unique<Gauge>();
+		return *slot;
+	}
+
+	Histogram &Registry::histogram(const std::string &name, const std::string &help, const std::string &labels,
+								   const std::vector<double> &bounds)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto &slot = family(name, Type::kHistogram, help).histograms[labels];
+		if (!slot)
+			slot = std::make_unique<Histogram>(bounds);
+		return *slot;
+	}
+
+	void Registry::addCollector(std::function<void()> collector)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		collectors_.push_back(std::move(collector));
+	}
+
+	CacheStats::CacheStats(const std::string &cache)
+		: hits_(Registry::instance().counter("gateway_cache_hits_total", "Gateway ARC cache hits",
+											 "cache=\"" + cache + "\"")),
+		  misses_(Registry::instance().counter("gateway_cache_misses_total", "Gateway ARC cache misses",
+											   "cache=\"" + cache + "\""))
+	{
+	}
+
+	RpcMetrics::RpcMetrics(const std::string &service, const std::string &method)
+		: latency_(Registry::instance().histogram("gateway_rpc_duration_seconds", "Backend gRPC call latency",
+												  "service=\"" + service + "\",method=\"" + method + "\"")),
+		  errors_(Registry::instance().counter("gateway_rpc_errors_total", "Backend gRPC calls that returned a non-OK status",
+											   "service=\"" + service + "\",method=\"" + method + "\"")),
+		  inflight_(Registry::instance().gauge("gateway_rpc_inflight", "Backend gRPC calls in flight",
+											   "service=\"" + service + "\",method=\"" + method + "\""))
+	{
+	}
+
+	void RpcMetrics::Timer::finish(bool ok) const
+	{
+		metrics_->inflight_.add(-1);
+		if (!ok)
+			metrics_->errors_.inc();
+		metrics_->latency_.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count());
+	}
+
+	std::string Registry::render() const
+	{
+		// 采集回调里会注册 / 更新指标，需要在持锁之前调用
+		std::vector<std::function<void()>> collectors;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			collectors = collectors_;
+		}
+		for (const auto &collect : collectors)
+			collect();
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::string out;
+		out.reserve(families_.size() * 256);
+		for (const auto &[name, fam] : families_)
+		{
+			const char *type = fam.type == Type::kCounter ? "counter" : fam.type == Type::kGauge ? "gauge"
+																								  : "histogram";
+			metrics::text::appendHeader(out, name, fam.help, type);
+			for (const auto &[labels, c] : fam.counters)
+				metrics::text::appendSample(out, name, labels, std::to_string(c->value()));
+			for (const auto &[labels, g] : fam.gauges)
+				metrics::text::appendSample(out, name, labels, std::to_string(g->value()));
+			for (const auto &[labels, h] : fam.histograms)
+			{
+				auto buckets = h->buckets();
+				std::vector<uint64_t> cumulatives;
+				cumulatives.reserve(h->bounds().size());
+				uint64_t cumulative = 0;
+				for (size_t i = 0; i < h->bounds().size(); ++i)
+				{
+					cumulative += buckets[i];
+					cumulatives.push_back(cumulative);
+				}
+				cumulative += buckets.back();
+				metrics::text::appendHistogram(out, name, labels, h->bounds(), cumulatives, cumulative, h->sum());
+			}
+		}
+		return out;
+	}
+}
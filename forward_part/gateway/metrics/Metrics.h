@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 网关指标（Prometheus 文本格式，由 /metrics 输出）
+// 指标对象注册后地址不变，调用方可以把引用缓存在静态变量里，热路径上只有原子操作。
+// Counter / Histogram 按线程分片：每个线程固定写自己的分片（独占缓存行），导出时求和，
+// IO 线程之间没有共享写，不会在同一个缓存行上来回争抢。
+namespace Metrics
+{
+	// 分片数不小于常见的 IO 线程数；线程更多时轮流共用分片，仍然无锁
+	constexpr size_t kShards = 16;
+
+	// 当前线程的分片号，首次调用时轮转分配
+	inline size_t threadShard()
+	{
+		static std::atomic<size_t> next{0};
+		thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+		return shard;
+	}
+
+	class Counter
+	{
+	public:
+		void inc(uint64_t n = 1) { shards_[threadShard()].value.fetch_add(n, std::memory_order_relaxed); }
+		uint64_t value() const
+		{
+			uint64_t sum = 0;
+			for (const auto &shard : shards_)
+				sum += shard.value.load(std::memory_order_relaxed);
+			return sum;
+		}
+
+	private:
+		struct alignas(64) Shard
+		{
+			std::atomic<uint64_t> value{0};
+		};
+		Shard shards_[kShards];
+	};
+
+	class Gauge
+	{
+	public:
+		void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+		void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+		int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<int64_t> value_{0};
+	};
+
+	// 固定桶直方图，bounds 为各桶上界（升序），最后隐含 +Inf 桶
+	// 每个分片占若干整缓存行：[各桶计数..., +Inf, sum]
+	class Histogram
+	{
+	public:
+		explicit Histogram(std::vector<double> bounds);
+
+		void observe(double v);
+
+		const std::vector<double> &bounds() const { return bounds_; }
+		// 各桶（非累计）计数，最后一个为 +Inf
+		std::vector<uint64_t> buckets() const;
+		double sum() const;
+		uint64_t count() const;
+
+	private:
+		struct alignas(64) Line
+		{
+			std::atomic<uint64_t> cells[8];
+		};
+
+		std::atomic<uint64_t> &cell(size_t shard, size_t i) const
+		{
+			return lines_[shard * linesPerShard_ + i / 8].cells[i % 8];
+		}
+
+		std::vector<double> bounds_;
+		size_t linesPerShard_;
+		size_t sumCell_; // sum 以 1e-6 为单位累加，避免浮点原子操作
+		std::unique_ptr<Line[]> lines_;
+	};
+
+	// 延迟类指标的默认桶（秒）
+	const std::vector<double> &latencyBuckets();
+
+	class Registry
+	{
+	public:
+		static Registry &instance();
+
+		// labels 形如 topic="email_verify",result="ok"；同名同标签重复注册返回同一个对象
+		Counter &counter(const std::string &name, const std::string &help, const std::string &labels = "");
+		Gauge &gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+		Histogram &histogram(const std::string &name, const std::string &help, const std::string &labels = "",
+							 const std::vector<double> &bounds = latencyBuckets());
+
+		// 导出前调用的采集回调，用于把外部状态（事件循环延迟等）刷新到 gauge
+		void addCollector(std::function<void()> collector);
+
+		std::string render() const;
+
+	private:
+		enum class Type
+		{
+			kCounter,
+			kGauge,
+			kHistogram,
+		};
+		struct Family
+		{
+			Type type;
+			std::string help;
+			std::map<std::string, std::unique_ptr<Counter>> counters;
+			std::map<std::string, std::unique_ptr<Gauge>> gauges;
+			std::map<std::string, std::unique_ptr<Histogram>> histograms;
+		};
+
+		Family &family(const std::string &name, Type type, const std::string &help);
+
+		mutable std::mutex mutex_;
+		std::map<std::string, Family> families_;
+		std::vector<std::function<void()>> collectors_;
+	};
+
+	// 缓存命中统计：cache 为缓存名，热路径上只是一次分片计数
+	class CacheStats
+	{
+	public:
+		explicit CacheStats(const std::string &cache);
+
+		void record(bool hit) { (hit ? hits_ : misses_).inc(); }
+
+	private:
+		Counter &hits_;
+		Counter &misses_;
+	};
+
+	// 后端 RPC 指标：每个调用点一个静态实例，发起时 start()，gRPC 回调里 finish()
+	class RpcMetrics
+	{
+	public:
+		class Timer
+		{
+		public:
+			void finish(bool ok) const;
+
+		private:
+			friend class RpcMetrics;
+			Timer(const RpcMetrics *metrics) : metrics_(metrics), start_(std::chrono::steady_clock::now()) {}
+
+			const RpcMetrics *metrics_;
+			std::chrono::steady_clock::time_point start_;
+		};
+
+		RpcMetrics(const std::string &service, const std::string &method);
+
+		Timer start() const
+		{
+			inflight_.add(1);
+			return Timer(this);
+		}
+
+	private:
+		Histogram &latency_;
+		Counter &errors_;
+		Gauge &inflight_;
+	};
+}
@@ -0,0 +1,69 @@
+#include "RequestMetrics.h"
+#include "Metrics.h"
+#include <drogon/drogon.h>
+#include <string>
+#include <unordered_map>
+
+namespace Metrics
+{
+	namespace
+	{
+		struct RouteMetrics
+		{
+			std::string labels;
+			Histogram &latency;
+			Gauge &inflight;
+			Counter *responses[6] = {}; // 按状态码首位（1xx..5xx）懒注册
+		};
+
+		// 每个 IO 线程一份 路由 -> 指标 的缓存，命中后不再经过 Registry 的锁
+		RouteMetrics &routeMetrics(const drogon::HttpRequestPtr &req)
+		{
+			thread_local std::unordered_map<std::string, std::unique_ptr<RouteMetrics>> cache;
+			std::string_view pattern = req->matchedPathPattern();
+			std::string key(req->methodString());
+			key += ' ';
+			key += pattern.empty() ? std::string_view("unmatched") : pattern;
+			auto it = cache.find(key);
+			if (it != cache.end())
+				return *it->second;
+
+			auto &reg = Registry::instance();
+			const size_t sep = key.find(' ');
+			std::string labels = "route=\"" + key.substr(sep + 1) + "\",method=\"" + key.substr(0, sep) + "\"";
+			auto metrics = std::unique_ptr<RouteMetrics>(new RouteMetrics{
+				labels,
+				reg.histogram("gateway_http_request_duration_seconds", "HTTP request latency from parse to response", labels),
+				reg.gauge("gateway_http_inflight_requests", "HTTP requests being handled", labels)});
+			return *cache.emplace(std::move(key), std::move(metrics)).first->second;
+		}
+
+		Counter &responses(RouteMetrics &route, int status)
+		{
+			const int cls = (status >= 100 && status < 600) ? status / 100 : 0;
+			if (!route.responses[cls])
+			{
+				const std::string code = cls == 0 ? "other" : std::to_string(cls) + "xx";
+				route.responses[cls] = &Registry::instance().counter(
+					"gateway_http_responses_total", "HTTP responses by status class",
+					route.labels + ",code=\"" + code + "\"");
+			}
+			return *route.responses[cls];
+		}
+	}
+
+	// pre / post handling 成对出现（都在过滤器之后），被过滤器拒绝的请求不计入路由指标；
+	// 耗时从请求解析完成（creationDate）算起，包含过滤器（JWT 校验、限流）的时间
+	void installRequestMetrics()
+	{
+		drogon::app().registerPreHandlingAdvice([](const drogon::HttpRequestPtr &req)
+												{ routeMetrics(req).inflight.add(1); });
+		drogon::app().registerPostHandlingAdvice([](const drogon::HttpRequestPtr &req, const drogon::HttpResponsePtr &resp)
+												 {
+			RouteMetrics &route = routeMetrics(req);
+			route.inflight.add(-1);
+			const int64_t us = trantor::Date::now().microSecondsSinceEpoch() - req->creationDate().microSecondsSinceEpoch();
+			route.latency.observe(static_cast<double>(us) / 1e6);
+			responses(route, static_cast<int>(resp->statusCode())).inc(); });
+	}
+}
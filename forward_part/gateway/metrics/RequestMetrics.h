@@ -0,0 +1,8 @@
+#pragma once
+
+// HTTP 请求指标：按路由模式（matchedPathPattern，不含路径参数，基数有界）和方法统计
+// 耗时、在途数和按状态码分类的响应数。在 app().run() 之前调用一次。
+namespace Metrics
+{
+	void installRequestMetrics();
+}
@@ -0,0 +1,279 @@
+#include "RateLimiter.h"
+#include "../../logs/Logger.h"
+#include "../redis/GatewayRedis.h"
+#include <drogon/drogon.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+
+namespace
+{
+	constexpr uint64_t kMilli = 1000; // 令牌的定点精度
+
+	// 固定窗口计数：第一次写入时设置过期，返回窗口内累计值
+	const char *const kIncrScript =
+		"local c = redis.call('INCRBY', KEYS[1], ARGV[1]) "
+		"if c == tonumber(ARGV[1]) then redis.call('EXPIRE', KEYS[1], ARGV[2]) end "
+		"return c";
+
+	uint64_t pack(uint32_t ms, uint32_t milliTokens)
+	{
+		return (static_cast<uint64_t>(ms) << 32) | milliTokens;
+	}
+
+	std::string trim(const std::string &s)
+	{
+		const size_t begin = s.find_first_not_of(" \t");
+		if (begin == std::string::npos)
+			return std::string();
+		return s.substr(begin, s.find_last_not_of(" \t") - begin + 1);
+	}
+
+	// entry 为单个 IP（v4 / v6）或 IPv4 CIDR
+	bool ipMatches(const std::string &ip, const std::string &entry)
+	{
+		const size_t slash = entry.find('/');
+		if (slash == std::string::npos)
+			return ip == entry;
+		in_addr addr{}, net{};
+		if (inet_pton(AF_INET, ip.c_str(), &addr) != 1 ||
+			inet_pton(AF_INET, entry.substr(0, slash).c_str(), &net) != 1)
+			return false;
+		const int bits = std::atoi(entry.c_str() + slash + 1);
+		if (bits <= 0)
+			return bits == 0;
+		const uint32_t mask = bits >= 32 ? 0xffffffffu : ~((1u << (32 - bits)) - 1);
+		return (ntohl(addr.s_addr) & mask) == (ntohl(net.s_addr) & mask);
+	}
+}
+
+std::string RateLimiter::clientIp(const std::string &peerIp, const std::string &realIp,
+								  const std::string &forwardedFor, const std::vector<std::string> &trustedProxies)
+{
+	const bool trusted = std::any_of(trustedProxies.begin(), trustedProxies.end(),
+									 [&peerIp](const std::string &entry)
+									 { return ipMatches(peerIp, entry); });
+	if (!trusted)
+		return peerIp;
+	std::string ip = trim(realIp);
+	if (!ip.empty())
+		return ip;
+	const size_t comma = forwardedFor.rfind(',');
+	ip = trim(comma == std::string::npos ? forwardedFor : forwardedFor.substr(comma + 1));
+	return ip.empty() ? peerIp : ip;
+}
+
+RateLimiter::RateLimiter()
+{
+	ruleStore_.emplace_back(new Rule());
+	for (auto &rs : rules_)
+	{
+		rs.rule.store(ruleStore_.front().get(), std::memory_order_relaxed);
+		rs.shards.reserve(kShardCount);
+		for (size_t i = 0; i < kShardCount; ++i)
+			rs.shards.emplace_back(std::make_unique<Shard>());
+	}
+}
+
+int64_t RateLimiter::nowMs()
+{
+	// 用墙上时钟：Redis 窗口编号需要在各副本之间对齐
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+			   std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+void RateLimiter::setRule(RuleId id, const Rule &rule)
+{
+	std::lock_guard<std::mutex> lock(ruleMutex_);
+	ruleStore_.emplace_back(new Rule(rule));
+	rules_[static_cast<size_t>(id)].rule.store(ruleStore_.back().get(), std::memory_order_release);
+}
+
+void RateLimiter::start(int syncIntervalMs)
+{
+	std::lock_guard<std::mutex> lock(timerMutex_);
+	auto loop = drogon::app().getLoop();
+	if (evictTimer_ == 0)
+		evictTimer_ = loop->runEvery(kEvictIntervalSec, [this]
+									 { evictIdle(); });
+	if (syncTimer_ != 0)
+	{
+		loop->invalidateTimer(syncTimer_);
+		syncTimer_ = 0;
+	}
+	syncing_.store(syncIntervalMs > 0, std::memory_order_relaxed);
+	if (syncIntervalMs <= 0)
+		return;
+	syncTimer_ = loop->runEvery(syncIntervalMs / 1000.0, [this]
+								{ sync(); });
+}
+
+RateLimiter::BucketPtr RateLimiter::bucketFor(RuleState &rs, const std::string &key)
+{
+	Shard &shard = *rs.shards[std::hash<std::string>{}(key) % rs.shards.size()];
+	{
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		auto it = shard.buckets.find(key);
+		if (it != shard.buckets.end())
+			return it->second;
+	}
+	auto bucket = std::make_shared<Bucket>();
+	const Rule &rule = *rs.rule.load(std::memory_order_acquire);
+	bucket->state.store(pack(static_cast<uint32_t>(nowMs()), static_cast<uint32_t>(rule.burst * kMilli)),
+						std::memory_order_relaxed);
+	std::unique_lock<std::shared_mutex> lock(shard.mutex);
+	if (shard.buckets.size() >= kMaxBucketsPerShard && shard.buckets.find(key) == shard.buckets.end())
+	{
+		if (!shard.overflow)
+			shard.overflow = std::move(bucket);
+		return shard.overflow;
+	}
+	return shard.buckets.emplace(key, std::move(bucket)).first->second;
+}
+
+bool RateLimiter::take(const Rule &rule, Bucket &bucket, int64_t now)
+{
+	const uint32_t nowLow = static_cast<uint32_t>(now);
+	const uint64_t capacity = static_cast<uint64_t>(rule.burst) * kMilli;
+	uint64_t old = bucket.state.load(std::memory_order_acquire);
+	for (;;)
+	{
+		uint32_t last = static_cast<uint32_t>(old >> 32);
+		uint64_t tokens = static_cast<uint32_t>(old);
+		uint32_t elapsed = nowLow - last; // 无符号回绕
+		// 时钟回拨时 elapsed 会变成极大值，按 0 处理
+		if (elapsed > 0x7fffffffu)
+			elapsed = 0;
+		uint64_t refill = static_cast<uint64_t>(elapsed * rule.ratePerMinute * kMilli / 60000.0);
+		tokens = std::min(capacity, tokens + refill);
+		if (tokens < kMilli)
+			return false;
+		uint64_t next = pack(refill ? nowLow : last, static_cast<uint32_t>(tokens - kMilli));
+		if (bucket.state.compare_exchange_weak(old, next, std::memory_order_acq_rel, std::memory_order_acquire))
+			return true;
+	}
+}
+
+bool RateLimiter::allow(RuleId id, const std::string &key, int &retryAfterSec)
+{
+	RuleState &rs = rules_[static_cast<size_t>(id)];
+	const Rule &rule = *rs.rule.load(std::memory_order_acquire);
+	if (rule.ratePerMinute <= 0 || key.empty())
+		return true;
+
+	const int64_t now = nowMs();
+	BucketPtr bucket = bucketFor(rs, key);
+	bucket->lastUsedMs.store(now, std::memory_order_relaxed);
+
+	int64_t blockedUntil = bucket->blockedUntilMs.load(std::memory_order_relaxed);
+	if (blockedUntil > now)
+	{
+		retryAfterSec = static_cast<int>((blockedUntil - now) / 1000 + 1);
+		return false;
+	}
+	if (!take(rule, *bucket, now))
+	{
+		retryAfterSec = std::max(1, static_cast<int>(60.0 / rule.ratePerMinute));
+		return false;
+	}
+	bucket->pending.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void RateLimiter::sync()
+{
+	auto redis = GatewayRedis::instance().client();
+	const int64_t now = nowMs();
+	const int64_t window = now / (kWindowSec * 1000);
+	const int64_t windowEndMs = (window + 1) * kWindowSec * 1000;
+
+	for (auto &rs : rules_)
+	{
+		const Rule &rule = *rs.rule.load(std::memory_order_acquire);
+		if (rule.ratePerMinute <= 0)
+			continue;
+		// 窗口内允许的全局总量：按速率折算 + 一个突发量
+		const int64_t globalLimit = static_cast<int64_t>(rule.ratePerMinute * kWindowSec / 60.0) + rule.burst;
+
+		for (auto &shardPtr : rs.shards)
+		{
+			Shard &shard = *shardPtr;
+			std::vector<std::pair<std::string, BucketPtr>> dirty;
+			{
+				std::shared_lock<std::shared_mutex> lock(shard.mutex);
+				for (auto &[key, bucket] : shard.buckets)
+				{
+					if (bucket->pending.load(std::memory_order_relaxed) > 0)
+						dirty.emplace_back(key, bucket);
+				}
+			}
+
+			if (redis)
+			{
+				for (auto &[key, bucket] : dirty)
+				{
+					uint32_t hits = bucket->pending.exchange(0, std::memory_order_relaxed);
+					if (hits == 0)
+						continue;
+					std::string redisKey = "ratelimit:" + rule.name + ":" + key + ":" + std::to_string(window);
+					redis->execCommandAsync(
+						[bucket, globalLimit, windowEndMs](const drogon::nosql::RedisResult &r)
+						{
+							if (r.type() == drogon::nosql::RedisResultType::kInteger && r.asInteger() > globalLimit)
+								bucket->blockedUntilMs.store(windowEndMs, std::memory_order_relaxed);
+						},
+						[](const drogon::nosql::RedisException &err)
+						{ LOG_ERROR("[RateLimiter] redis sync failed: {}", err.what()); },
+						"eval %s 1 %s %u %d", kIncrScript, redisKey.c_str(), hits, kWindowSec * 2);
+				}
+			}
+			else
+			{
+				for (auto &[key, bucket] : dirty)
+					bucket->pending.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+// 回收长时间不用的桶（只有 map 自己持有引用时才删）；开启同步时未同步的计数留到同步之后再回收
+void RateLimiter::evictIdle()
+{
+	const int64_t now = nowMs();
+	const bool syncing = syncing_.load(std::memory_order_relaxed);
+	for (auto &rs : rules_)
+	{
+		for (auto &shardPtr : rs.shards)
+		{
+			Shard &shard = *shardPtr;
+			bool hasIdle = false;
+			{
+				std::shared_lock<std::shared_mutex> lock(shard.mutex);
+				for (auto &[key, bucket] : shard.buckets)
+				{
+					if (now - bucket->lastUsedMs.load(std::memory_order_relaxed) > kIdleEvictMs)
+					{
+						hasIdle = true;
+						break;
+					}
+				}
+			}
+			if (!hasIdle)
+				continue;
+
+			std::unique_lock<std::shared_mutex> lock(shard.mutex);
+			for (auto it = shard.buckets.begin(); it != shard.buckets.end();)
+			{
+				const auto &b = it->second;
+				if (b.use_count() == 1 && (!syncing || b->pending.load(std::memory_order_relaxed) == 0) &&
+					now - b->lastUsedMs.load(std::memory_order_relaxed) > kIdleEvictMs)
+					it = shard.buckets.erase(it);
+				else
+					++it;
+			}
+		}
+	}
+}
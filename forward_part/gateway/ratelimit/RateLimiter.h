@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 网关限流
+// 本地：每个 (规则, key) 一个令牌桶，令牌数和上次补充时间打包进一个 64 位原子量，取令牌是一次 CAS，不加锁。
+// 跨副本：定时把各桶在本周期放行的次数用 Lua INCRBY+EXPIRE 累加到 Redis 的固定窗口计数上；
+// 窗口内全局计数超过上限的 key 在本地标记封禁到窗口结束，之后的请求直接拒绝。
+// 被拒绝的请求在进入 Kafka / gRPC 之前就返回 429。
+class RateLimiter
+{
+public:
+	struct Rule
+	{
+		std::string name;		 // 规则名，同时作为 Redis key 前缀的一部分
+		double ratePerMinute = 0; // 令牌补充速率，<= 0 表示不限
+		int burst = 1;			 // 桶容量
+	};
+
+	enum class RuleId
+	{
+		kSendcodeIp,
+		kSendcodeEmail,
+		kSigninIp,
+		kSigninUser,
+		kCount,
+	};
+
+	static RateLimiter &instance()
+	{
+		static RateLimiter limiter;
+		return limiter;
+	}
+
+	// 可在运行中调用（配置热更新）：规则整体替换，请求线程无锁读取
+	void setRule(RuleId id, const Rule &rule);
+
+	// 在 Redis 客户端创建之后调用，启动周期同步；syncIntervalMs <= 0 时只做本地限流。
+	// 空闲桶的回收有单独的定时器，不论是否同步都会启动。再次调用会按新的周期重排同步定时器
+	void start(int syncIntervalMs);
+
+	// 放行返回 true；拒绝时 retryAfterSec 给出建议的重试间隔
+	bool allow(RuleId id, const std::string &key, int &retryAfterSec);
+
+	// 按 IP 限流用的客户端地址：网关在 nginx 之后，直连对端是受信代理时取 X-Real-IP，
+	// 没有则取 X-Forwarded-For 的最后一跳（nginx 追加的 $remote_addr）；否则用对端地址，防止伪造头绕过限流
+	static std::string clientIp(const std::string &peerIp, const std::string &realIp,
+								const std::string &forwardedFor, const std::vector<std::string> &trustedProxies);
+
+private:
+	struct Bucket
+	{
+		// 高 32 位：上次补充时间（毫秒，按 2^32 回绕）；低 32 位：剩余令牌（千分之一个令牌为单位）
+		std::atomic<uint64_t> state{0};
+		std::atomic<uint32_t> pending{0};		 // 上次同步以来本地放行次数
+		std::atomic<int64_t> blockedUntilMs{0}; // 全局超限后的本地封禁截止时间
+		std::atomic<int64_t> lastUsedMs{0};
+	};
+	using BucketPtr = std::shared_ptr<Bucket>;
+
+	struct Shard
+	{
+		std::shared_mutex mutex;
+		std::unordered_map<std::string, BucketPtr> buckets;
+		// 分片中的桶达到上限后，新 key 共用这一个桶（不进 map、不参与同步），
+		// 大量伪造 key 只能分到这一份令牌，也撑不大内存
+		BucketPtr overflow;
+	};
+
+	struct RuleState
+	{
+		std::atomic<const Rule *> rule{nullptr}; // 指向 ruleStore_ 中的不可变规则
+		std::vector<std::unique_ptr<Shard>> shards;
+	};
+
+	RateLimiter();
+
+	static int64_t nowMs();
+	BucketPtr bucketFor(RuleState &rs, const std::string &key);
+	bool take(const Rule &rule, Bucket &bucket, int64_t now);
+	void sync();
+	void evictIdle();
+
+	static constexpr size_t kShardCount = 16;
+	static constexpr int kWindowSec = 60;		  // Redis 固定窗口长度，与 ratePerMinute 对应
+	static constexpr int64_t kIdleEvictMs = 600000; // 空闲超过 10 分钟的桶被回收
+	static constexpr double kEvictIntervalSec = 60;	  // 空闲桶回收周期
+	static constexpr size_t kMaxBucketsPerShard = 65536;
+
+	RuleState rules_[static_cast<size_t>(RuleId::kCount)];
+	// 发布过的规则都保留：请求线程可能仍在读旧规则，规则变更次数很少
+	std::mutex ruleMutex_;
+	std::vector<std::unique_ptr<const Rule>> ruleStore_;
+	std::mutex timerMutex_;
+	uint64_t syncTimer_ = 0;  // trantor::TimerId，0 表示未启动
+	uint64_t evictTimer_ = 0;
+	std::atomic<bool> syncing_{false};
+};
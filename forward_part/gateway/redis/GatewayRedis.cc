@@ -0,0 +1,66 @@
+#include "GatewayRedis.h"
+#include "../../logs/Logger.h"
+#include <algorithm>
+
+namespace
+{
+	// KEYS[1] 验证码  KEYS[2] 该验证码的错误次数（hash：code 记录针对的是哪个验证码，n 为次数）
+	// ARGV[1] 提交的验证码  ARGV[2] 允许的错误次数
+	// 1: 匹配并已删除  0: 不匹配  -1: 不存在  -2: 错误次数用尽，验证码已作废
+	// 计数跟着验证码走：重新下发了新验证码时旧计数作废，过期时间与验证码一致
+	const char *const kVerifyScript =
+		"local v = redis.call('GET', KEYS[1]) "
+		"if not v then return -1 end "
+		"if v == ARGV[1] then redis.call('DEL', KEYS[1], KEYS[2]) return 1 end "
+		"local n "
+		"if redis.call('HGET', KEYS[2], 'code') == v then n = redis.call('HINCRBY', KEYS[2], 'n', 1) "
+		"else redis.call('DEL', KEYS[2]) redis.call('HSET', KEYS[2], 'code', v, 'n', 1) n = 1 end "
+		"local ttl = redis.call('PTTL', KEYS[1]) "
+		"if ttl > 0 then redis.call('PEXPIRE', KEYS[2], ttl) else redis.call('EXPIRE', KEYS[2], 600) end "
+		"if n >= tonumber(ARGV[2]) then redis.call('DEL', KEYS[1], KEYS[2]) return -2 end "
+		"return 0";
+}
+
+void GatewayRedis::init(const std::string &host, int port, size_t connectionsPerThread, size_t ioThreads)
+{
+	size_t connections = std::max<size_t>(1, connectionsPerThread) * std::max<size_t>(1, ioThreads);
+	auto client = drogon::nosql::RedisClient::newRedisClient(
+		trantor::InetAddress(host, static_cast<uint16_t>(port)), connections);
+	LOG_INFO("[GatewayRedis] {}:{} with {} connection(s)", host, port, connections);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	client_ = std::move(client);
+}
+
+void GatewayRedis::verifyCode(const std::string &key, const std::string &code, std::function<void(VerifyResult)> &&cb)
+{
+	auto redis = client();
+	if (!redis)
+		return cb(VerifyResult::kError);
+
+	auto done = std::make_shared<std::function<void(VerifyResult)>>(std::move(cb));
+	redis->execCommandAsync(
+		[done](const drogon::nosql::RedisResult &r)
+		{
+			if (r.type() != drogon::nosql::RedisResultType::kInteger)
+				return (*done)(VerifyResult::kError);
+			switch (r.asInteger())
+			{
+			case 1:
+				return (*done)(VerifyResult::kMatched);
+			case 0:
+				return (*done)(VerifyResult::kMismatch);
+			case -2:
+				return (*done)(VerifyResult::kTooManyAttempts);
+			default:
+				return (*done)(VerifyResult::kNotFound);
+			}
+		},
+		[done](const drogon::nosql::RedisException &err)
+		{
+			LOG_ERROR("[GatewayRedis] verify failed: {}", err.what());
+			(*done)(VerifyResult::kError);
+		},
+		"eval %s 2 %s %s %s %d", kVerifyScript, key.c_str(), (key + ":verify_attempts").c_str(), code.c_str(),
+		kMaxVerifyAttempts);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 网关的 Redis 访问层
+// 自己持有一个 RedisClient，连接数 = 每个 IO 线程的连接数 × IO 线程数（redis.connections_per_thread）。
+// drogon 的 Redis 连接本身会把同一连接上的并发命令连续写出（pipelining），不等上一条的回复，
+// 连接数够多时各 IO 线程的命令不会排在同一个 socket 后面。
+// 业务代码统一通过 client() 取客户端，便于之后替换底层实现。
+class GatewayRedis
+{
+public:
+	enum class VerifyResult
+	{
+		kMatched,         // 验证码正确，且已被删除（一次性）
+		kMismatch,        // 验证码错误，保留原值
+		kTooManyAttempts, // 错误次数用尽，验证码已删除，需重新获取
+		kNotFound,        // 不存在或已过期/已被使用
+		kError,
+	};
+
+	static GatewayRedis &instance()
+	{
+		static GatewayRedis redis;
+		return redis;
+	}
+
+	void init(const std::string &host, int port, size_t connectionsPerThread, size_t ioThreads);
+
+	drogon::nosql::RedisClientPtr client() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return client_;
+	}
+
+	// 同一验证码最多允许的错误次数，达到后验证码作废，防止在有效期内穷举 6 位数字
+	static constexpr int kMaxVerifyAttempts = 5;
+
+	// 原子地比对并删除验证码：GET + 比较 + DEL 在一个 Lua 脚本里完成，同一验证码只能成功一次；
+	// 错误次数记在 <key>:verify_attempts，与比对在同一脚本里累加，达到 kMaxVerifyAttempts 即删除验证码
+	void verifyCode(const std::string &key, const std::string &code, std::function<void(VerifyResult)> &&cb);
+
+private:
+	GatewayRedis() = default;
+
+	mutable std::mutex mutex_;
+	drogon::nosql::RedisClientPtr client_;
+};
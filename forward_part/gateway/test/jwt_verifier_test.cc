@@ -0,0 +1,185 @@
+// JwtVerifier 快速路径：签名、算法、长度上限、时间声明，以及 refresh token 的用途限制
+#include "auth/JwtVerifier.h"
+#include "auth/TokenService.h"
+#include <drogon/drogon_test.h>
+#include <openssl/hmac.h>
+#include <ctime>
+#include <string>
+
+namespace
+{
+	const std::string kKey = "gateway-test-signing-key";
+
+	std::string base64Url(const std::string &in)
+	{
+		static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+		std::string out;
+		uint32_t acc = 0;
+		int bits = 0;
+		for (unsigned char c : in)
+		{
+			acc = (acc << 8) | c;
+			bits += 8;
+			while (bits >= 6)
+			{
+				bits -= 6;
+				out.push_back(alphabet[(acc >> bits) & 0x3F]);
+			}
+		}
+		if (bits > 0)
+			out.push_back(alphabet[(acc << (6 - bits)) & 0x3F]);
+		return out;
+	}
+
+	// 任意 header / payload，用 kKey 做 HS256 签名（header 声明的 alg 不影响实际签名算法）
+	std::string makeToken(const std::string &header, const std::string &payload)
+	{
+		std::string signingInput = base64Url(header) + "." + base64Url(payload);
+		unsigned char mac[EVP_MAX_MD_SIZE];
+		unsigned int macLen = 0;
+		HMAC(EVP_sha256(), kKey.data(), static_cast<int>(kKey.size()),
+			 reinterpret_cast<const unsigned char *>(signingInput.data()), signingInput.size(), mac, &macLen);
+		return signingInput + "." + base64Url(std::string(reinterpret_cast<char *>(mac), macLen));
+	}
+
+	const std::string kHs256Header = R"({"alg":"HS256","typ":"JWT"})";
+
+	std::string payloadWith(const std::string &extra)
+	{
+		return R"({"ID":42,"Name":"alice","iss":"Signin")" + extra + "}";
+	}
+
+	long now()
+	{
+		return static_cast<long>(std::time(nullptr));
+	}
+
+	JwtVerifier::Result verify(const std::string &token)
+	{
+		JwtClaims claims;
+		return JwtVerifier::verify(token, claims);
+	}
+}
+
+DROGON_TEST(JwtVerifierAcceptsValidToken)
+{
+	JwtVerifier::setSigningKey(kKey);
+	JwtClaims claims;
+	const long exp = now() + 3600;
+	auto token = makeToken(kHs256Header, payloadWith(R"(,"exp":)" + std::to_string(exp)));
+	REQUIRE(JwtVerifier::verify(token, claims) == JwtVerifier::Result::kOk);
+	CHECK(claims.id == 42);
+	CHECK(claims.name == "alice");
+	CHECK(claims.exp == exp);
+	CHECK(claims.typ.empty());
+}
+
+DROGON_TEST(JwtVerifierRejectsTamperedSignature)
+{
+	JwtVerifier::setSigningKey(kKey);
+	auto token = makeToken(kHs256Header, payloadWith(R"(,"exp":)" + std::to_string(now() + 3600)));
+
+	// 改签名的第一个字符（最后一个字符含填充位，改了可能不影响解码结果）
+	std::string badSig = token;
+	size_t sig = badSig.rfind('.') + 1;
+	badSig[sig] = badSig[sig] == 'A' ? 'B' : 'A';
+	CHECK(verify(badSig) == JwtVerifier::Result::kInvalid);
+
+	// 签名不变，换一个 payload
+	std::string badPayload = makeToken(kHs256Header, payloadWith(R"(,"exp":)" + std::to_string(now() + 7200)));
+	badPayload = badPayload.substr(0, badPayload.rfind('.')) + token.substr(token.rfind('.'));
+	CHECK(verify(badPayload) == JwtVerifier::Result::kInvalid);
+
+	// 用别的密钥签发
+	JwtVerifier::setSigningKey("another-key");
+	CHECK(verify(token) == JwtVerifier::Result::kInvalid);
+	JwtVerifier::setSigningKey(kKey);
+	CHECK(verify(token) == JwtVerifier::Result::kOk);
+
+	CHECK(verify("not-a-jwt") == JwtVerifier::Result::kInvalid);
+	CHECK(verify(token + ".extra") == JwtVerifier::Result::kInvalid);
+}
+
+DROGON_TEST(JwtVerifierFallsBackOnOtherAlgorithms)
+{
+	JwtVerifier::setSigningKey(kKey);
+	const std::string payload = payloadWith(R"(,"exp":)" + std::to_string(now() + 3600));
+	CHECK(verify(makeToken(R"({"alg":"HS512","typ":"JWT"})", payload)) == JwtVerifier::Result::kUnsupported);
+	CHECK(verify(makeToken(R"({"alg":"none","typ":"JWT"})", payload)) == JwtVerifier::Result::kUnsupported);
+	CHECK(verify(makeToken(R"({"typ":"JWT"})", payload)) == JwtVerifier::Result::kUnsupported);
+}
+
+DROGON_TEST(JwtVerifierFallsBackOnOversizedParts)
+{
+	JwtVerifier::setSigningKey(kKey);
+	const std::string payload = payloadWith(R"(,"exp":)" + std::to_string(now() + 3600));
+
+	// 解码后 header 上限 256 字节，payload 上限 1024 字节
+	std::string bigHeader = R"({"alg":"HS256","typ":"JWT","kid":")" + std::string(300, 'k') + "\"}";
+	CHECK(verify(makeToken(bigHeader, payload)) == JwtVerifier::Result::kUnsupported);
+
+	std::string bigPayload = payloadWith(R"(,"exp":)" + std::to_string(now() + 3600) + R"(,"pad":")" + std::string(1100, 'p') + "\"");
+	CHECK(verify(makeToken(kHs256Header, bigPayload)) == JwtVerifier::Result::kUnsupported);
+
+	// 刚好 1024 字节的仍走快速路径
+	const std::string prefix = R"(,"exp":)" + std::to_string(now() + 3600) + R"(,"pad":")";
+	const size_t padLen = 1024 - payloadWith(prefix + "\"").size();
+	std::string fitPayload = payloadWith(prefix + std::string(padLen, 'p') + "\"");
+	REQUIRE(fitPayload.size() == 1024);
+	CHECK(verify(makeToken(kHs256Header, fitPayload)) == JwtVerifier::Result::kOk);
+}
+
+DROGON_TEST(JwtVerifierTimeClaimBoundaries)
+{
+	JwtVerifier::setSigningKey(kKey);
+	const long t = now();
+
+	// exp：now >= exp 即过期
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"exp":)" + std::to_string(t)))) == JwtVerifier::Result::kExpired);
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"exp":)" + std::to_string(t - 1)))) == JwtVerifier::Result::kExpired);
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"exp":)" + std::to_string(t + 60)))) == JwtVerifier::Result::kOk);
+
+	// nbf / iat：now < 声明值即无效，等于时有效
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"nbf":)" + std::to_string(t + 60)))) == JwtVerifier::Result::kInvalid);
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"nbf":)" + std::to_string(t)))) == JwtVerifier::Result::kOk);
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"iat":)" + std::to_string(t + 60)))) == JwtVerifier::Result::kInvalid);
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"iat":)" + std::to_string(t)))) == JwtVerifier::Result::kOk);
+
+	// 浮点时间交给 jwt-cpp
+	CHECK(verify(makeToken(kHs256Header, payloadWith(R"(,"exp":1e12)"))) == JwtVerifier::Result::kUnsupported);
+}
+
+DROGON_TEST(JwtVerifierRequiresIssuerAndIdentity)
+{
+	JwtVerifier::setSigningKey(kKey);
+	const std::string exp = std::to_string(now() + 3600);
+	CHECK(verify(makeToken(kHs256Header, R"({"ID":42,"Name":"alice","iss":"Other","exp":)" + exp + "}")) == JwtVerifier::Result::kInvalid);
+	CHECK(verify(makeToken(kHs256Header, R"({"Name":"alice","iss":"Signin","exp":)" + exp + "}")) == JwtVerifier::Result::kInvalid);
+	CHECK(verify(makeToken(kHs256Header, R"({"ID":42,"iss":"Signin","exp":)" + exp + "}")) == JwtVerifier::Result::kInvalid);
+}
+
+DROGON_TEST(RefreshTokenOnlyUsableForRefresh)
+{
+	JwtVerifier::setSigningKey(kKey);
+	auto &tokens = TokenService::instance();
+
+	// jwt_decode 按 typ 拒绝 refresh token 访问业务接口
+	JwtClaims claims;
+	const std::string refreshToken = tokens.issueRefresh(7, "bob");
+	REQUIRE(JwtVerifier::verify(refreshToken, claims) == JwtVerifier::Result::kOk);
+	CHECK(claims.typ == "refresh");
+
+	int64_t exp = 0;
+	const std::string accessToken = tokens.issueAccess(7, "bob", exp);
+	REQUIRE(JwtVerifier::verify(accessToken, claims) == JwtVerifier::Result::kOk);
+	CHECK(claims.typ.empty());
+
+	// 换取 access token 只认 refresh token
+	std::string issued, err;
+	CHECK(!tokens.refresh(accessToken, issued, exp, err));
+	CHECK(err == "not a refresh token");
+	CHECK(tokens.refresh(refreshToken, issued, exp, err));
+	CHECK(JwtVerifier::verify(issued, claims) == JwtVerifier::Result::kOk);
+	CHECK(claims.id == 7);
+	CHECK(claims.typ.empty());
+}
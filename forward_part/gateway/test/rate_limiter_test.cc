@@ -0,0 +1,77 @@
+// RateLimiter：本地令牌桶（突发、补充、按 key 隔离）与客户端地址的取法
+#include "ratelimit/RateLimiter.h"
+#include <drogon/drogon_test.h>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	// 测试共用单例，每个用例用自己的 key 前缀，互不影响
+	RateLimiter::Rule rule(double ratePerMinute, int burst)
+	{
+		RateLimiter::Rule r;
+		r.name = "test";
+		r.ratePerMinute = ratePerMinute;
+		r.burst = burst;
+		return r;
+	}
+}
+
+DROGON_TEST(TokenBucketAllowsBurstThenRejects)
+{
+	auto &limiter = RateLimiter::instance();
+	limiter.setRule(RateLimiter::RuleId::kSendcodeIp, rule(60, 3));
+	int retryAfter = 0;
+	for (int i = 0; i < 3; ++i)
+		CHECK(limiter.allow(RateLimiter::RuleId::kSendcodeIp, "burst-1.2.3.4", retryAfter));
+	retryAfter = 0;
+	CHECK(!limiter.allow(RateLimiter::RuleId::kSendcodeIp, "burst-1.2.3.4", retryAfter));
+	CHECK(retryAfter == 1); // 每分钟 60 个，一秒补一个
+
+	// 另一个 key 有自己的桶
+	CHECK(limiter.allow(RateLimiter::RuleId::kSendcodeIp, "burst-5.6.7.8", retryAfter));
+}
+
+DROGON_TEST(TokenBucketRefillsOverTime)
+{
+	auto &limiter = RateLimiter::instance();
+	limiter.setRule(RateLimiter::RuleId::kSigninIp, rule(6000, 1)); // 每 10ms 一个
+	int retryAfter = 0;
+	CHECK(limiter.allow(RateLimiter::RuleId::kSigninIp, "refill", retryAfter));
+	CHECK(!limiter.allow(RateLimiter::RuleId::kSigninIp, "refill", retryAfter));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(limiter.allow(RateLimiter::RuleId::kSigninIp, "refill", retryAfter));
+	// 补充不超过桶容量：空闲再久也只能连续放行 burst 个
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(limiter.allow(RateLimiter::RuleId::kSigninIp, "refill", retryAfter));
+	CHECK(!limiter.allow(RateLimiter::RuleId::kSigninIp, "refill", retryAfter));
+}
+
+DROGON_TEST(TokenBucketDisabledRule)
+{
+	auto &limiter = RateLimiter::instance();
+	limiter.setRule(RateLimiter::RuleId::kSigninUser, rule(0, 1));
+	int retryAfter = 0;
+	for (int i = 0; i < 100; ++i)
+		CHECK(limiter.allow(RateLimiter::RuleId::kSigninUser, "unlimited", retryAfter));
+
+	// 空 key 不限流（取不到限流维度时放行）
+	limiter.setRule(RateLimiter::RuleId::kSendcodeEmail, rule(1, 1));
+	CHECK(limiter.allow(RateLimiter::RuleId::kSendcodeEmail, "", retryAfter));
+	CHECK(limiter.allow(RateLimiter::RuleId::kSendcodeEmail, "", retryAfter));
+}
+
+DROGON_TEST(ClientIpOnlyTrustsConfiguredProxies)
+{
+	const std::vector<std::string> trusted{"127.0.0.1", "10.0.0.0/8"};
+
+	// 受信代理：优先 X-Real-IP，其次 X-Forwarded-For 的最后一跳
+	CHECK(RateLimiter::clientIp("127.0.0.1", "203.0.113.5", "198.51.100.1", trusted) == "203.0.113.5");
+	CHECK(RateLimiter::clientIp("10.1.2.3", "", "198.51.100.1, 203.0.113.9 ", trusted) == "203.0.113.9");
+	CHECK(RateLimiter::clientIp("10.1.2.3", "", "", trusted) == "10.1.2.3");
+
+	// 直连对端不受信时忽略转发头，防止伪造绕过限流
+	CHECK(RateLimiter::clientIp("198.51.100.7", "1.1.1.1", "2.2.2.2", trusted) == "198.51.100.7");
+	CHECK(RateLimiter::clientIp("11.0.0.1", "1.1.1.1", "", trusted) == "11.0.0.1");
+	CHECK(RateLimiter::clientIp("127.0.0.1", "1.1.1.1", "", {}) == "127.0.0.1");
+}
@@ -1,8 +1,88 @@
 #include "internal.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 using json = nlohmann::json;
 using namespace nacos;
 
+namespace
+{
+	// 已发布的全部快照；只在发布时追加，读者可能仍持有任意一份的引用
+	std::mutex g_publishMutex;
+	std::vector<std::unique_ptr<const AppConfig>> g_snapshots;
+	std::vector<std::pair<int, ConfigSubscriber>> g_subscribers;
+	int g_nextSubscriberId = 0;
+
+	const AppConfig *initialSnapshot()
+	{
+		g_snapshots.emplace_back(new AppConfig());
+		return g_snapshots.back().get();
+	}
+}
+
+std::atomic<const AppConfig *> AppConfig::current_{initialSnapshot()};
+
+const AppConfig &AppConfig::publish(AppConfig next)
+{
+	std::lock_guard<std::mutex> lock(g_publishMutex);
+	const AppConfig *prev = current_.load(std::memory_order_acquire);
+	g_snapshots.emplace_back(new AppConfig(std::move(next)));
+	const AppConfig *cur = g_snapshots.back().get();
+	current_.store(cur, std::memory_order_release);
+	for (auto &sub : g_subscribers)
+	{
+		try
+		{
+			sub.second(*prev, *cur);
+		}
+		catch (const std::exception &e)
+		{
+			LOG_ERROR("[Config] subscriber {} failed: {}", sub.first, e.what());
+		}
+	}
+	return *cur;
+}
+
+int SubscribeConfig(ConfigSubscriber subscriber, const AppConfig *basis)
+{
+	std::lock_guard<std::mutex> lock(g_publishMutex);
+	// 在发布锁内补发：与发布线程互斥，basis 之后的快照恰好送达一次
+	const AppConfig *cur = &AppConfig::getInstance();
+	if (basis && basis != cur)
+	{
+		try
+		{
+			subscriber(*basis, *cur);
+		}
+		catch (const std::exception &e)
+		{
+			LOG_ERROR("[Config] subscriber {} failed: {}", g_nextSubscriberId + 1, e.what());
+		}
+	}
+	g_subscribers.emplace_back(++g_nextSubscriberId, std::move(subscriber));
+	return g_nextSubscriberId;
+}
+
+void UnsubscribeConfig(int id)
+{
+	std::lock_guard<std::mutex> lock(g_publishMutex);
+	for (auto it = g_subscribers.begin(); it != g_subscribers.end(); ++it)
+	{
+		if (it->first == id)
+		{
+			g_subscribers.erase(it);
+			return;
+		}
+	}
+}
+
 class ConfigListener : public Listener
 {
 public:
@@ -10,21 +90,29 @@ public:
 	{
 		std::cout << "[Nacos] Config updated:\n"
 				  << configInfo << std::endl;
-		LoadConfigFromString(configInfo);
+		if (LoadConfigFromString(configInfo))
+			SaveSnapshot(configInfo);
 	}
 
-	static void LoadConfigFromString(const std::string &content)
+	// 解析并发布新快照，成功返回 true
+	static bool LoadConfigFromString(const std::string &content)
 	{
 		try
 		{
 			auto j = json::parse(content);
 
-			AppConfig &cfg = AppConfig::getInstance();
+			// 在当前快照的副本上修改，解析完整成功后才整体发布；中途失败不影响正在使用的配置
+			AppConfig cfg = AppConfig::getInstance();
 			cfg.kafka.host = j["kafka"]["host"];
 			cfg.kafka.port = j["kafka"]["port"];
+			cfg.kafka.linger_ms = j["kafka"].value("linger_ms", cfg.kafka.linger_ms);
+			cfg.kafka.batch_num_messages = j["kafka"].value("batch_num_messages", cfg.kafka.batch_num_messages);
+			cfg.kafka.queue_max_messages = j["kafka"].value("queue_max_messages", cfg.kafka.queue_max_messages);
+			cfg.kafka.compression = j["kafka"].value("compression", cfg.kafka.compression);
 
 			cfg.redis.host = j["redis"]["host"];
 			cfg.redis.port = j["redis"]["port"];
+			cfg.redis.connections_per_thread = j["redis"].value("connections_per_thread", cfg.redis.connections_per_thread);
 
 			cfg.mysql.host = j["mysql"]["host"];
 			cfg.mysql.port = j["mysql"]["port"];
@@ -38,62 +126,164 @@ public:
 			cfg.consul.gateway_srv.host = j["consul"]["gateway_srv"]["host"];
 
 			cfg.jwt.secret = j["jwt"]["signing_key"];
+			cfg.jwt.access_ttl_sec = j["jwt"].value("access_ttl_sec", cfg.jwt.access_ttl_sec);
+			cfg.jwt.refresh_ttl_sec = j["jwt"].value("refresh_ttl_sec", cfg.jwt.refresh_ttl_sec);
+
+			if (j.contains("cache"))
+			{
+				cfg.cache.userinfo_local_ttl_sec = j["cache"].value("userinfo_local_ttl_sec", cfg.cache.userinfo_local_ttl_sec);
+				cfg.cache.userinfo_redis_ttl_sec = j["cache"].value("userinfo_redis_ttl_sec", cfg.cache.userinfo_redis_ttl_sec);
+			}
+
+			if (j.contains("ratelimit"))
+			{
+				const auto &rl = j["ratelimit"];
+				auto loadRule = [&rl](const char *name, RateLimitRuleConfig &rule)
+				{
+					if (!rl.contains(name))
+						return;
+					rule.per_minute = rl[name].value("per_minute", rule.per_minute);
+					rule.burst = rl[name].value("burst", rule.burst);
+				};
+				cfg.ratelimit.sync_interval_ms = rl.value("sync_interval_ms", cfg.ratelimit.sync_interval_ms);
+				loadRule("sendcode_ip", cfg.ratelimit.sendcode_ip);
+				loadRule("sendcode_email", cfg.ratelimit.sendcode_email);
+				loadRule("signin_ip", cfg.ratelimit.signin_ip);
+				loadRule("signin_user", cfg.ratelimit.signin_user);
+				if (rl.contains("trusted_proxies"))
+					cfg.ratelimit.trusted_proxies = rl["trusted_proxies"].get<std::vector<std::string>>();
+			}
+
+			if (j.contains("health"))
+			{
+				cfg.health.probe_interval_ms = j["health"].value("probe_interval_ms", cfg.health.probe_interval_ms);
+				cfg.health.max_loop_lag_ms = j["health"].value("max_loop_lag_ms", cfg.health.max_loop_lag_ms);
+				cfg.health.redis_max_age_ms = j["health"].value("redis_max_age_ms", cfg.health.redis_max_age_ms);
+				if (j["health"].contains("required_backends"))
+					cfg.health.required_backends = j["health"]["required_backends"].get<std::vector<std::string>>();
+			}
 
+			AppConfig::publish(std::move(cfg));
 			std::cout << "[Nacos] Config parsed successfully\n";
+			return true;
 		}
 		catch (std::exception &e)
 		{
 			std::cerr << "[ERROR] Failed to parse config: " << e.what() << std::endl;
+			return false;
 		}
 	}
-};
 
-void InitAppConfig()
-{
+	// 最近一次成功解析的 Nacos 配置原文落盘（写临时文件再 rename，不会留下半个文件）
+	static void SaveSnapshot(const std::string &content)
+	{
+		const std::string path = SnapshotPath();
+		const std::string tmp = path + ".tmp";
+		{
+			std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+			if (!out || !(out << content) || !out.flush())
+			{
+				LOG_ERROR("[Config] write snapshot {} failed", tmp);
+				return;
+			}
+		}
+		// 快照里有密钥和数据库口令，只允许本用户读写
+		::chmod(tmp.c_str(), 0600);
+		if (std::rename(tmp.c_str(), path.c_str()) != 0)
+			LOG_ERROR("[Config] rename snapshot to {} failed", path);
+	}
 
-	// 1. 创建 Properties
-	Properties props;
-	props[PropertyKeyConst::SERVER_ADDR] = "192.168.149.128:30848";
-	props[PropertyKeyConst::NAMESPACE] = "ce99961c-0fcf-4f4f-81d6-ac2183f24df1";
-	props[PropertyKeyConst::AUTH_USERNAME] = "nacos";
-	props[PropertyKeyConst::AUTH_PASSWORD] = "nacos";
-	// 2. 正确的工厂（旧版 API）
-	INacosServiceFactory *factory = NacosFactoryFactory::getNacosFactory(props);
-	ResourceGuard<INacosServiceFactory> guardFactory(factory);
-
-	// 3. 创建 ConfigService
-	ConfigService *configSvc = factory->CreateConfigService();
-	ResourceGuard<ConfigService> guardConfig(configSvc);
-
-	// 4. 监听配置
-	ConfigListener *listener = new ConfigListener();
-	configSvc->addListener("clouddisk.json", "dev", listener);
-
-	// 5. 获取初始配置
-	NacosString content;
-	try
+	static bool LoadSnapshot()
 	{
-		content = configSvc->getConfig("clouddisk.json", "dev", 5000);
+		std::ifstream in(SnapshotPath(), std::ios::binary);
+		if (!in)
+			return false;
+		std::stringstream buf;
+		buf << in.rdbuf();
+		if (!LoadConfigFromString(buf.str()))
+			return false;
+		LOG_INFO("[Config] booted from local snapshot {}", SnapshotPath());
+		return true;
 	}
-	catch (NacosException &e)
+
+	static std::string SnapshotPath()
 	{
-		std::cerr << "[ERROR] getConfig failed: "
-				  << e.errorcode() << " " << e.what() << std::endl;
-		LOG_ERROR("[ERROR] getConfig failed: ", e.errorcode(), e.what());
-		return;
+		const char *path = std::getenv("CONFIG_SNAPSHOT_PATH");
+		return path && *path ? path : "clouddisk.snapshot.json";
 	}
+};
 
-	if (content.empty())
+namespace
+{
+	std::string EnvOr(const char *name, const char *fallback)
 	{
-		std::cerr << "[ERROR] empty config!" << std::endl;
-		LOG_ERROR("[ERROR] empty config!");
-		return;
+		const char *v = std::getenv(name);
+		return v && *v ? v : fallback;
 	}
 
-	std::cout << "[Nacos] Initial config:\n"
-			  << content << std::endl;
+	// 连接 Nacos、注册监听并拉取一次配置；成功拉到并解析时返回 true
+	bool ConnectNacos()
+	{
+		// 1. 创建 Properties（地址等可用环境变量覆盖）
+		Properties props;
+		props[PropertyKeyConst::SERVER_ADDR] = EnvOr("NACOS_SERVER_ADDR", "192.168.149.128:30848");
+		props[PropertyKeyConst::NAMESPACE] = EnvOr("NACOS_NAMESPACE", "ce99961c-0fcf-4f4f-81d6-ac2183f24df1");
+		props[PropertyKeyConst::AUTH_USERNAME] = EnvOr("NACOS_USERNAME", "nacos");
+		props[PropertyKeyConst::AUTH_PASSWORD] = EnvOr("NACOS_PASSWORD", "nacos");
+		// 2. 正确的工厂（旧版 API）
+		// factory / ConfigService 与进程同寿命：监听器要一直收到推送，不能在函数返回时析构
+		static INacosServiceFactory *factory = NacosFactoryFactory::getNacosFactory(props);
+
+		// 3. 创建 ConfigService
+		static ConfigService *configSvc = factory->CreateConfigService();
+
+		// 4. 监听配置
+		ConfigListener *listener = new ConfigListener();
+		configSvc->addListener("clouddisk.json", "dev", listener);
 
-	ConfigListener::LoadConfigFromString(content);
+		// 5. 获取初始配置
+		NacosString content;
+		try
+		{
+			content = configSvc->getConfig("clouddisk.json", "dev", 5000);
+		}
+		catch (NacosException &e)
+		{
+			std::cerr << "[ERROR] getConfig failed: "
+					  << e.errorcode() << " " << e.what() << std::endl;
+			LOG_ERROR("[ERROR] getConfig failed: ", e.errorcode(), e.what());
+			return false;
+		}
+
+		if (content.empty())
+		{
+			std::cerr << "[ERROR] empty config!" << std::endl;
+			LOG_ERROR("[ERROR] empty config!");
+			return false;
+		}
+
+		std::cout << "[Nacos] Initial config:\n"
+				  << content << std::endl;
+
+		if (!ConfigListener::LoadConfigFromString(content))
+			return false;
+		ConfigListener::SaveSnapshot(content);
+		return true;
+	}
+}
+
+bool InitAppConfig()
+{
+	// 有本地快照就先用它启动，Nacos 在后台连接，拉到的新配置经订阅者生效；
+	// 没有快照（首次部署）时只能同步等 Nacos
+	if (ConfigListener::LoadSnapshot())
+	{
+		std::thread([]
+					{ ConnectNacos(); })
+			.detach();
+		return true;
+	}
+	return ConnectNacos();
 }
 
 // 获取未占用的port
@@ -2,7 +2,10 @@
 #define INTERNAL_H
 
 #pragma once
+#include <atomic>
+#include <functional>
 #include <string>
+#include <vector>
 #include "Nacos.h"
 #include <nlohmann/json.hpp>
 #include <iostream>
@@ -20,12 +23,17 @@ struct RedisConfig
 {
 	std::string host;
 	std::string port;
+	int connections_per_thread = 2; // 网关每个 IO 线程对应的 Redis 连接数
 };
 
 struct KafkaConfig
 {
 	std::string host;
 	std::string port;
+	int linger_ms = 5;				   // 生产者攒批等待时间
+	int batch_num_messages = 1000;	   // 单批最大消息数
+	int queue_max_messages = 100000;   // 网关内待发送队列上限，满则 sendcode 返回 503
+	std::string compression = "lz4";   // 生产者压缩算法：none / lz4 / zstd
 };
 
 struct MysqlConfig
@@ -48,8 +56,46 @@ struct ConsulConfig
 struct JWTConfig
 {
 	std::string secret;
+	int access_ttl_sec = 900;			 // 网关签发的 access token 有效期
+	int refresh_ttl_sec = 7 * 24 * 3600; // refresh token 有效期
 };
 
+struct CacheConfig
+{
+	int userinfo_local_ttl_sec = 30;  // 网关进程内 Userinfo 缓存有效期
+	int userinfo_redis_ttl_sec = 300; // Redis 中共享的 Userinfo 缓存有效期
+};
+
+struct RateLimitRuleConfig
+{
+	double per_minute = 0; // <= 0 表示不限
+	int burst = 1;
+};
+
+struct RateLimitConfig
+{
+	int sync_interval_ms = 1000; // 本地计数同步到 Redis 的周期，<= 0 时只做单机限流
+	RateLimitRuleConfig sendcode_ip{10, 10};
+	RateLimitRuleConfig sendcode_email{2, 2};
+	RateLimitRuleConfig signin_ip{60, 30};
+	RateLimitRuleConfig signin_user{10, 10};
+	// 受信代理（nginx）地址，单个 IP 或 IPv4 CIDR；只有直连对端在列表中时才采信 X-Real-IP / X-Forwarded-For
+	std::vector<std::string> trusted_proxies{"127.0.0.1", "::1"};
+};
+
+struct HealthConfig
+{
+	int probe_interval_ms = 1000; // 后台依赖探测 / 事件循环延迟采样周期
+	int max_loop_lag_ms = 200;	  // 任一 IO 循环延迟超过该值即不就绪
+	int redis_max_age_ms = 5000;  // 最近一次 Redis PING 成功距今超过该值即不就绪
+	// 不可用时使网关不就绪的后端；其余后端不可用只在 /ready 中标记 degraded。
+	// 后端是所有网关共用的，默认都不参与就绪判断，避免一个后端故障把全部网关摘掉
+	std::vector<std::string> required_backends;
+};
+
+// 配置快照：每次 Nacos 推送解析成一份新的 AppConfig，整体替换当前指针（RCU 风格）
+// - 读：getInstance() 只有一次 acquire load，不加锁；拿到的引用指向不可变快照，始终有效
+// - 写：只有 Nacos 回调线程发布，旧快照不释放（配置变更很少、每份几 KB），读者无需宽限期
 class AppConfig
 {
 public:
@@ -58,21 +104,34 @@ public:
 	ConsulConfig consul;
 	JWTConfig jwt;
 	KafkaConfig kafka;
-	/// ---- 单例全局访问接口 ----
-	static AppConfig &getInstance()
+	CacheConfig cache;
+	RateLimitConfig ratelimit;
+	HealthConfig health;
+	/// ---- 当前快照 ----
+	static const AppConfig &getInstance()
 	{
-		static AppConfig instance; // C++11 线程安全
-		return instance;
+		return *current_.load(std::memory_order_acquire);
 	}
 
-private:
-	AppConfig() = default;
-	~AppConfig() = default;
+	// 发布新快照并依次通知订阅者，返回发布后的快照
+	static const AppConfig &publish(AppConfig next);
 
-	AppConfig(const AppConfig &) = delete;
-	AppConfig &operator=(const AppConfig &) = delete;
+private:
+	static std::atomic<const AppConfig *> current_;
 };
-void InitAppConfig(void);
+
+// 订阅者在发布线程中按注册顺序调用，prev 为替换前的快照；
+// 回调里按需比较字段，只重建真正变了的组件（重连 Redis / Kafka、调整连接数等）
+// basis 为订阅方初始化时所用的快照：不是当前快照时，先在发布锁内以 (basis, 当前) 调用一次补上期间的推送
+using ConfigSubscriber = std::function<void(const AppConfig &prev, const AppConfig &next)>;
+int SubscribeConfig(ConfigSubscriber subscriber, const AppConfig *basis = nullptr);
+// 不能在订阅回调中调用
+void UnsubscribeConfig(int id);
+
+// 加载配置：优先用本地 last-known-good 快照立即返回（CONFIG_SNAPSHOT_PATH，默认 ./clouddisk.snapshot.json），
+// 同时在后台连接 Nacos（NACOS_SERVER_ADDR 等环境变量可覆盖地址）；没有快照时同步拉取。
+// 返回是否已有可用配置
+bool InitAppConfig(void);
 // 获取未占用的port
 int GetFreePort();
 #endif // !INTERNAL_H
\ No newline at end of file
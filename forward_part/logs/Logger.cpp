@@ -2,53 +2,291 @@
 
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/rotating_file_sink.h>
-#include <spdlog/async.h>
+#include <spdlog/sinks/sink.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 std::shared_ptr<spdlog::logger> GlobalLogger::logger_ = nullptr;
+std::atomic<size_t> GlobalLogger::infoSampleEvery_{1};
+
+namespace
+{
+	constexpr size_t kRingCapacity = 4096;						   // 每个线程的缓冲条数
+	constexpr auto kFlushInterval = std::chrono::milliseconds(50); // 写线程最长等待，即最大落盘延迟
+
+	// 业务线程只拷贝这几个字段（消息体的 string 复用容量，预热后不再分配内存），格式化放到写线程
+	struct Record
+	{
+		int64_t timeUs = 0;
+		spdlog::level::level_enum level = spdlog::level::info;
+		size_t threadId = 0;
+		std::string text;
+	};
+
+	// 单生产者（所属业务线程）/ 单消费者（写线程）环形缓冲
+	class Ring
+	{
+	public:
+		Ring() : slots_(kRingCapacity) {}
+
+		bool push(const spdlog::details::log_msg &msg)
+		{
+			const size_t head = head_.load(std::memory_order_relaxed);
+			if (head - tail_.load(std::memory_order_acquire) >= slots_.size())
+				return false;
+			Record &r = slots_[head % slots_.size()];
+			r.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(msg.time.time_since_epoch()).count();
+			r.level = msg.level;
+			r.threadId = msg.thread_id;
+			r.text.assign(msg.payload.data(), msg.payload.size());
+			head_.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		size_t size() const
+		{
+			return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+		}
+
+		template <typename F>
+		size_t drain(F &&write)
+		{
+			size_t tail = tail_.load(std::memory_order_relaxed);
+			const size_t head = head_.load(std::memory_order_acquire);
+			const size_t n = head - tail;
+			for (; tail != head; ++tail)
+				write(slots_[tail % slots_.size()]);
+			tail_.store(tail, std::memory_order_release);
+			return n;
+		}
+
+		std::atomic<bool> orphaned{false}; // 所属线程已退出，写线程取空后回收
+
+	private:
+		std::vector<Record> slots_;
+		alignas(64) std::atomic<size_t> head_{0};
+		alignas(64) std::atomic<size_t> tail_{0};
+	};
+
+	// 异步 sink：log() 只写本线程的环形缓冲；写线程每 kFlushInterval（或被 WARN 以上 / 缓冲过半唤醒）
+	// 取空所有缓冲，按紧凑格式写入后端 sink，每批只 flush 一次
+	// 紧凑格式：2026-01-02T03:04:05.123456 I 12345 消息
+	class RingSink : public spdlog::sinks::sink
+	{
+	public:
+		explicit RingSink(std::vector<spdlog::sink_ptr> backends)
+			: backends_(std::move(backends))
+		{
+			for (auto &sink : backends_)
+				sink->set_pattern("%v");
+			writer_ = std::thread([this]
+								  { run(); });
+		}
+
+		~RingSink() override { stop(); }
+
+		void log(const spdlog::details::log_msg &msg) override
+		{
+			Ring &ring = threadRing();
+			if (!ring.push(msg))
+			{
+				dropped_.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			if (msg.level >= spdlog::level::warn || ring.size() > kRingCapacity / 2)
+				wake();
+		}
+
+		// 不在调用线程上刷盘，只提前唤醒写线程
+		void flush() override { wake(); }
+
+		// 格式固定为紧凑格式，忽略外部设置
+		void set_pattern(const std::string &) override {}
+		void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (stopping_)
+					return;
+				stopping_ = true;
+			}
+			cv_.notify_one();
+			if (writer_.joinable())
+				writer_.join();
+		}
+
+	private:
+		struct RingHolder
+		{
+			RingSink *owner = nullptr;
+			std::shared_ptr<Ring> ring;
+			~RingHolder()
+			{
+				if (ring)
+					ring->orphaned.store(true, std::memory_order_release);
+			}
+		};
+
+		Ring &threadRing()
+		{
+			thread_local RingHolder holder;
+			if (holder.owner != this)
+			{
+				if (holder.ring)
+					holder.ring->orphaned.store(true, std::memory_order_release);
+				holder.ring = std::make_shared<Ring>();
+				holder.owner = this;
+				std::lock_guard<std::mutex> lock(mutex_);
+				rings_.push_back(holder.ring);
+			}
+			return *holder.ring;
+		}
+
+		void wake()
+		{
+			if (!pending_.exchange(true, std::memory_order_acq_rel))
+				cv_.notify_one();
+		}
+
+		void run()
+		{
+			std::vector<std::shared_ptr<Ring>> rings;
+			while (true)
+			{
+				bool stopping;
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					cv_.wait_for(lock, kFlushInterval, [this]
+								 { return stopping_ || pending_.load(std::memory_order_acquire); });
+					pending_.store(false, std::memory_order_release);
+					stopping = stopping_;
+					// 回收线程已退出且已取空的缓冲
+					rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring> &r)
+												{ return r->orphaned.load(std::memory_order_acquire) && r->size() == 0; }),
+								 rings_.end());
+					rings = rings_;
+				}
+
+				size_t written = 0;
+				for (auto &ring : rings)
+					written += ring->drain([this](const Record &r)
+										   { write(r); });
+				const uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+				if (dropped > 0)
+				{
+					Record r;
+					r.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+								   std::chrono::system_clock::now().time_since_epoch())
+								   .count();
+					r.level = spdlog::level::warn;
+					r.text = fmt::format("[log] {} record(s) dropped, ring buffer full", dropped);
+					write(r);
+					++written;
+				}
+				if (written > 0)
+				{
+					for (auto &sink : backends_)
+						sink->flush();
+				}
+				if (stopping)
+					return;
+			}
+		}
+
+		void write(const Record &r)
+		{
+			const time_t sec = static_cast<time_t>(r.timeUs / 1000000);
+			if (sec != cachedSec_)
+			{
+				std::tm tm{};
+				localtime_r(&sec, &tm);
+				cachedSecLen_ = std::strftime(cachedSecStr_, sizeof(cachedSecStr_), "%Y-%m-%dT%H:%M:%S", &tm);
+				cachedSec_ = sec;
+			}
+			line_.clear();
+			fmt::format_to(std::back_inserter(line_), "{}.{:06d} {} {} {}",
+						   fmt::string_view(cachedSecStr_, cachedSecLen_), r.timeUs % 1000000,
+						   spdlog::level::to_short_c_str(r.level), r.threadId, r.text);
+			spdlog::details::log_msg msg(spdlog::source_loc{}, "global_logger", r.level,
+										 spdlog::string_view_t(line_.data(), line_.size()));
+			for (auto &sink : backends_)
+			{
+				if (sink->should_log(r.level))
+					sink->log(msg);
+			}
+		}
+
+		std::vector<spdlog::sink_ptr> backends_; // 只在写线程中使用
+
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		bool stopping_ = false;
+		std::atomic<bool> pending_{false};
+		std::vector<std::shared_ptr<Ring>> rings_;
+		std::atomic<uint64_t> dropped_{0};
+		std::thread writer_;
+
+		// 写线程的格式化缓存
+		fmt::memory_buffer line_;
+		time_t cachedSec_ = -1;
+		char cachedSecStr_[32];
+		size_t cachedSecLen_ = 0;
+	};
+}
 
 void GlobalLogger::init(const std::string &filename,
 						size_t max_size,
 						size_t max_files,
-						bool async_mode)
+						bool async_mode,
+						size_t info_sample_every)
 {
 	if (logger_)
 		return; // 防止重复初始化
 
+	infoSampleEvery_.store(info_sample_every == 0 ? 1 : info_sample_every, std::memory_order_relaxed);
+
 	try
 	{
-		// 控制台输出
-		auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-		console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e][%l] %v");
-
-		// 滚动日志文件
-		auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-			filename, max_size, max_files);
-		file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e][%l] %v");
-
-		std::vector<spdlog::sink_ptr> sinks{console_sink, file_sink};
-
 		if (async_mode)
 		{
-			// 异步日志队列（默认 8192 条）
-			spdlog::init_thread_pool(8192, 1);
-			logger_ = std::make_shared<spdlog::async_logger>(
-				"global_logger",
-				sinks.begin(),
-				sinks.end(),
-				spdlog::thread_pool(),
-				spdlog::async_overflow_policy::block);
+			// 后端 sink 只由写线程访问，用无锁的 _st 版本
+			std::vector<spdlog::sink_ptr> backends{
+				std::make_shared<spdlog::sinks::stdout_color_sink_st>(),
+				std::make_shared<spdlog::sinks::rotating_file_sink_st>(filename, max_size, max_files)};
+			auto ring_sink = std::make_shared<RingSink>(std::move(backends));
+			logger_ = std::make_shared<spdlog::logger>("global_logger", ring_sink);
+			// 刷盘由写线程按批完成；ERROR 以上只是提前唤醒写线程
+			logger_->flush_on(spdlog::level::err);
 		}
 		else
 		{
+			// 控制台输出
+			auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+			console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e][%l] %v");
+
+			// 滚动日志文件
+			auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+				filename, max_size, max_files);
+			file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e][%l] %v");
+
+			std::vector<spdlog::sink_ptr> sinks{console_sink, file_sink};
 			logger_ = std::make_shared<spdlog::logger>(
 				"global_logger",
 				sinks.begin(),
 				sinks.end());
+			logger_->flush_on(spdlog::level::info);
 		}
 
 		spdlog::register_logger(logger_);
 		logger_->set_level(spdlog::level::debug);
-		logger_->flush_on(spdlog::level::info);
 	}
 	catch (const spdlog::spdlog_ex &ex)
 	{
@@ -57,7 +295,18 @@ void GlobalLogger::init(const std::string &filename,
 	}
 }
 
-std::shared_ptr<spdlog::logger> GlobalLogger::get()
+void GlobalLogger::shutdown()
+{
+	if (!logger_)
+		return;
+	for (auto &sink : logger_->sinks())
+	{
+		if (auto ring_sink = std::dynamic_pointer_cast<RingSink>(sink))
+			ring_sink->stop();
+	}
+}
+
+const std::shared_ptr<spdlog::logger> &GlobalLogger::get()
 {
 	if (!logger_)
 	{
@@ -1,6 +1,7 @@
 #ifndef GLOBAL_LOGGER_H
 #define GLOBAL_LOGGER_H
 
+#include <atomic>
 #include <memory>
 #include <spdlog/spdlog.h>
 #include <spdlog/logger.h>
@@ -9,17 +10,28 @@ class GlobalLogger
 {
 public:
 	// 获取全局 logger（线程安全，C++11 保证）
-	static std::shared_ptr<spdlog::logger> get();
+	// 返回引用：每条日志都会调用，避免 shared_ptr 引用计数在线程间争抢
+	static const std::shared_ptr<spdlog::logger> &get();
 
 	// 初始化（可调用一次，不调用则使用默认）
+	// async_mode：业务线程只把消息放进本线程的无锁环形缓冲，由后台写线程批量格式化、写文件并定时刷盘；
+	//             缓冲满时丢弃并计数，不阻塞业务线程
+	// info_sample_every：LOG_INFO_SAMPLED 每个调用点每个线程每 N 条记录 1 条
 	static void init(const std::string &filename = "/home/lihaoqian/myproject/clouddisk_v2/forward_part/logs/app.log",
 					 size_t max_size = 10 * 1024 * 1024,
 					 size_t max_files = 3,
-					 bool async_mode = false);
+					 bool async_mode = true,
+					 size_t info_sample_every = 100);
+
+	// 进程退出前调用：写完缓冲中剩余的日志并停止写线程
+	static void shutdown();
+
+	static size_t infoSampleEvery() { return infoSampleEvery_.load(std::memory_order_relaxed); }
 
 private:
 	GlobalLogger() = default;
 	static std::shared_ptr<spdlog::logger> logger_;
+	static std::atomic<size_t> infoSampleEvery_;
 };
 
 // ------ 全局宏，和 glog 一样使用 ------
@@ -29,4 +41,14 @@ private:
 #define LOG_ERROR(...) SPDLOG_LOGGER_ERROR(GlobalLogger::get(), __VA_ARGS__)
 #define LOG_CRITICAL(...) SPDLOG_LOGGER_CRITICAL(GlobalLogger::get(), __VA_ARGS__)
 
+// 每个请求都会走到的 INFO 日志（成功路径、缓存命中等）用这个，按调用点采样；
+// 失败和 WARN 及以上的日志不要采样
+#define LOG_INFO_SAMPLED(...)                                                  \
+	do                                                                         \
+	{                                                                          \
+		static thread_local size_t logSampleCounter = 0;                       \
+		if (logSampleCounter++ % GlobalLogger::infoSampleEvery() == 0)         \
+			LOG_INFO(__VA_ARGS__);                                             \
+	} while (0)
+
 #endif // GLOBAL_LOGGER_H
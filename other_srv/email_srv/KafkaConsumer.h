@@ -4,10 +4,18 @@
 #include "config/config.h"
 #include "emailsend.h"
 #include "emailServer.h"
+#include "offsettracker.h"
 #include <librdkafka/rdkafka.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 static std::atomic<bool> g_running{true};
 
+// 批量消费 + 有界在途 + 手动提交
+// - rd_kafka_consume_batch_queue 一次取一批消息
+// - 在途任务数超过高水位时暂停所有已分配分区，降到低水位以下再恢复，内存有上界
+// - 关闭自动提交，任务处理完成后才推进 offset（OffsetTracker 只提交连续完成的前缀），at-least-once
 class KafkaConsumer
 {
 public:
@@ -21,6 +29,7 @@ public:
 		if (rd_kafka_conf_set(conf, "group.id", cfg_.group_id.c_str(),
 							  errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
 		{
+			rd_kafka_conf_destroy(conf);
 			throw std::runtime_error(string("Failed to set group.id: ") + errstr);
 		}
 
@@ -28,11 +37,17 @@ public:
 		if (rd_kafka_conf_set(conf, "bootstrap.servers", cfg_.brokers.c_str(),
 							  errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
 		{
+			rd_kafka_conf_destroy(conf);
 			throw std::runtime_error(string("Failed to set bootstrap.servers: ") + errstr);
 		}
 
-		// 自动提交 offset
-		rd_kafka_conf_set(conf, "enable.auto.commit", "true", nullptr, 0);
+		// 手动提交 offset：任务完成后才提交
+		rd_kafka_conf_set(conf, "enable.auto.commit", "false", nullptr, 0);
+		rd_kafka_conf_set(conf, "enable.auto.offset.store", "false", nullptr, 0);
+
+		// 分区分配变化时需要提交 / 重置在途跟踪
+		rd_kafka_conf_set_opaque(conf, this);
+		rd_kafka_conf_set_rebalance_cb(conf, &KafkaConsumer::rebalanceCb);
 
 		// 创建 consumer
 		rk_ = rd_kafka_new(RD_KAFKA_CONSUMER, conf, errstr, sizeof(errstr));
@@ -43,6 +58,7 @@ public:
 
 		// 订阅 topic
 		rd_kafka_poll_set_consumer(rk_);
+		queue_ = rd_kafka_queue_get_consumer(rk_);
 
 		rd_kafka_topic_partition_list_t *topics =
 			rd_kafka_topic_partition_list_new(1);
@@ -55,11 +71,24 @@ public:
 			throw std::runtime_error(string("Failed to subscribe: ") + rd_kafka_err2str(err));
 		}
 
+		std::weak_ptr<OffsetTracker> tracker = tracker_;
+		metrics::Registry::instance().gaugeFn("email_kafka_in_flight", "Consumed messages not yet fully processed", "",
+											  [tracker]
+											  {
+												  auto t = tracker.lock();
+												  return t ? t->inFlight() : 0;
+											  });
+
 		std::cout << "[Kafka] Consumer subscribed to topic: " << cfg_.topic << std::endl;
 	}
 
 	~KafkaConsumer()
 	{
+		if (queue_)
+		{
+			rd_kafka_queue_destroy(queue_);
+			queue_ = nullptr;
+		}
 		if (rk_)
 		{
 			rd_kafka_consumer_close(rk_);
@@ -70,57 +99,237 @@ public:
 
 	void loop()
 	{
-		while (g_running)
+		const size_t batchSize = cfg_.batch_size > 0 ? cfg_.batch_size : 100;
+		const int64_t highWater = cfg_.max_in_flight > 0 ? cfg_.max_in_flight : 1000;
+		const int64_t lowWater = highWater / 2;
+		const auto commitInterval = std::chrono::milliseconds(cfg_.commit_interval_ms > 0 ? cfg_.commit_interval_ms : 1000);
+
+		std::vector<rd_kafka_message_t *> batch(batchSize);
+		auto lastCommit = std::chrono::steady_clock::now();
+
+		while (g_running && !restart_.load())
 		{
-			rd_kafka_message_t *rkmessage =
-				rd_kafka_consumer_poll(rk_, 1000); // 1秒超时
-			if (!rkmessage)
-				continue;
+			// 背压：在途任务过多时暂停拉取，但仍需调用 consume 以处理 rebalance 等事件
+			int64_t inFlight = tracker_->inFlight();
+			if (!paused_ && inFlight >= highWater)
+				setPaused(true);
+			else if (paused_ && inFlight <= lowWater)
+				setPaused(false);
 
-			if (rkmessage->err)
+			ssize_t n = rd_kafka_consume_batch_queue(queue_, 100, batch.data(), batch.size());
+			for (ssize_t i = 0; i < n; ++i)
 			{
-				if (rkmessage->err == RD_KAFKA_RESP_ERR__PARTITION_EOF)
-				{
-					// 正常到达分区末尾
-				}
-				else if (rkmessage->err == RD_KAFKA_RESP_ERR__ALL_BROKERS_DOWN)
-				{
-					std::cerr << "[Kafka] All brokers down, will keep retrying..." << std::endl;
-				}
-				else
-				{
-					std::cerr << "[Kafka] Error: " << rd_kafka_message_errstr(rkmessage) << std::endl;
-				}
-				rd_kafka_message_destroy(rkmessage);
-				continue;
+				dispatch(batch[i]);
+				rd_kafka_message_destroy(batch[i]);
 			}
 
-			// 正常消息
-			if (rkmessage->payload && rkmessage->len > 0)
+			auto now = std::chrono::steady_clock::now();
+			if (now - lastCommit >= commitInterval)
 			{
-				string email((char *)rkmessage->payload, rkmessage->len);
-				// 你目前是把 email 当纯字符串发过来的，这里兼容一下 %40 -> @
-				size_t pos = email.find("%40");
-				if (pos != string::npos)
-				{
-					email.replace(pos, 3, "@");
-				}
-
-				std::cout << "[Kafka] Received email task: " << email << std::endl;
-				EmailTask task{email};
-				emailSvc_.enqueue(task);
+				commit(true);
+				updateLag();
+				lastCommit = now;
 			}
-
-			rd_kafka_message_destroy(rkmessage);
 		}
 
+		drain();
 		std::cout << "[Kafka] loop exited" << std::endl;
 	}
 
+	// 配置热更新：kafka 段变化时由订阅回调调用，loop() 排空后返回，由调用方用新配置重建 consumer
+	void requestRestart() { restart_.store(true); }
+
 private:
+	// 停机排空：暂停拉取，等在途任务在 shutdown_drain_ms 内做完，期间照常提交；
+	// 最后同步提交一次，只包含已完成的连续前缀，超时未完成的留给重启后重投
+	void drain()
+	{
+		setPaused(true);
+		const int64_t before = tracker_->inFlight();
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(cfg_.shutdown_drain_ms, 0));
+		const auto commitInterval = std::chrono::milliseconds(cfg_.commit_interval_ms > 0 ? cfg_.commit_interval_ms : 1000);
+		auto lastCommit = std::chrono::steady_clock::now();
+		while (tracker_->inFlight() > 0 && std::chrono::steady_clock::now() < deadline)
+		{
+			// 继续驱动 consumer 队列，以便处理 rebalance 等事件（分区已暂停，不会再取到消息）
+			rd_kafka_message_t *msg = rd_kafka_consume_queue(queue_, 50);
+			if (msg)
+				rd_kafka_message_destroy(msg);
+			auto now = std::chrono::steady_clock::now();
+			if (now - lastCommit >= commitInterval)
+			{
+				commit(true);
+				lastCommit = now;
+			}
+		}
+		commit(false);
+		const int64_t left = tracker_->inFlight();
+		std::cout << "[Kafka] Drained " << (before - left) << " in-flight task(s), "
+				  << left << " left for redelivery" << std::endl;
+	}
+
+	void dispatch(rd_kafka_message_t *rkmessage)
+	{
+		if (rkmessage->err)
+		{
+			if (rkmessage->err == RD_KAFKA_RESP_ERR__PARTITION_EOF)
+			{
+				// 正常到达分区末尾
+			}
+			else if (rkmessage->err == RD_KAFKA_RESP_ERR__ALL_BROKERS_DOWN)
+			{
+				std::cerr << "[Kafka] All brokers down, will keep retrying..." << std::endl;
+			}
+			else
+			{
+				std::cerr << "[Kafka] Error: " << rd_kafka_message_errstr(rkmessage) << std::endl;
+			}
+			return;
+		}
+
+		const int32_t partition = rkmessage->partition;
+		const int64_t offset = rkmessage->offset;
+		tracker_->begin(partition, offset);
+
+		// 空消息也要走完成流程，否则提交点会卡住
+		const uint64_t generation = generation_;
+		// 回执持有 tracker 的共享所有权：consumer 先于线程池析构时，收尾中的任务仍可安全回执
+		auto ack = std::make_shared<TaskAck>([tracker = tracker_, generation, partition, offset]
+											 { tracker->complete(generation, partition, offset); },
+											 [tracker = tracker_, generation, partition, offset]
+											 { tracker->abandon(generation, partition, offset); });
+		if (!rkmessage->payload || rkmessage->len == 0)
+			return;
+
+		string email((char *)rkmessage->payload, rkmessage->len);
+		// 你目前是把 email 当纯字符串发过来的，这里兼容一下 %40 -> @
+		size_t pos = email.find("%40");
+		if (pos != string::npos)
+		{
+			email.replace(pos, 3, "@");
+		}
+
+		std::cout << "[Kafka] Received email task: " << email << std::endl;
+		EmailTask task{std::move(email), std::move(ack)};
+		// 消息令牌：重投时据此认出同一条消息，沿用已生成的验证码
+		task.token = cfg_.topic + ":" + std::to_string(partition) + ":" + std::to_string(offset);
+		consumed_.inc();
+		// 生产者写入的时间戳即用户请求时间，用于截止时间判断
+		rd_kafka_timestamp_type_t tsType;
+		int64_t ts = rd_kafka_message_timestamp(rkmessage, &tsType);
+		if (tsType != RD_KAFKA_TIMESTAMP_NOT_AVAILABLE && ts > 0)
+		{
+			task.enqueueMs = ts;
+			EmailMetrics::instance().kafkaStage.observeMicros((unixMillis() - ts) * 1000);
+		}
+		// 线程池满时退避重试；高水位暂停通常会先生效
+		const auto enqueueStart = std::chrono::steady_clock::now();
+		bool queued = false;
+		while (!(queued = emailSvc_.enqueue(std::move(task))) && g_running)
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		enqueueWait_.observeMicros(elapsedMicros(enqueueStart));
+		// 停机时仍没排上队：不回执，offset 不提交，重启后重投
+		if (!queued)
+			task.ack->abandon();
+	}
+
+	// async=true 用于周期提交；分区回收和退出时用同步提交
+	void commit(bool async)
+	{
+		auto commits = tracker_->collect();
+		if (commits.empty())
+			return;
+		rd_kafka_topic_partition_list_t *offsets = rd_kafka_topic_partition_list_new((int)commits.size());
+		for (const auto &c : commits)
+			rd_kafka_topic_partition_list_add(offsets, cfg_.topic.c_str(), c.partition)->offset = c.offset;
+		rd_kafka_resp_err_t err = rd_kafka_commit(rk_, offsets, async ? 1 : 0);
+		if (err)
+			std::cerr << "[Kafka] Commit failed: " << rd_kafka_err2str(err) << std::endl;
+		rd_kafka_topic_partition_list_destroy(offsets);
+	}
+
+	// 消费滞后 = 高水位 - 当前消费位置；水位取 librdkafka 随拉取缓存的值，不额外请求 broker
+	void updateLag()
+	{
+		rd_kafka_topic_partition_list_t *assigned = nullptr;
+		if (rd_kafka_assignment(rk_, &assigned) != RD_KAFKA_RESP_ERR_NO_ERROR || !assigned)
+			return;
+		rd_kafka_position(rk_, assigned);
+		int64_t total = 0;
+		for (int i = 0; i < assigned->cnt; ++i)
+		{
+			const rd_kafka_topic_partition_t &tp = assigned->elems[i];
+			int64_t low = 0, high = 0;
+			if (tp.offset < 0 ||
+				rd_kafka_get_watermark_offsets(rk_, tp.topic, tp.partition, &low, &high) != RD_KAFKA_RESP_ERR_NO_ERROR)
+				continue;
+			int64_t lag = high > tp.offset ? high - tp.offset : 0;
+			total += lag;
+			metrics::Registry::instance()
+				.gauge("email_kafka_consumer_lag", "Messages behind the high watermark per partition",
+					   "partition=\"" + std::to_string(tp.partition) + "\"")
+				.set(lag);
+		}
+		lagTotal_.set(total);
+		rd_kafka_topic_partition_list_destroy(assigned);
+	}
+
+	void setPaused(bool pause)
+	{
+		rd_kafka_topic_partition_list_t *assigned = nullptr;
+		if (rd_kafka_assignment(rk_, &assigned) != RD_KAFKA_RESP_ERR_NO_ERROR || !assigned)
+			return;
+		rd_kafka_resp_err_t err = pause ? rd_kafka_pause_partitions(rk_, assigned)
+										: rd_kafka_resume_partitions(rk_, assigned);
+		rd_kafka_topic_partition_list_destroy(assigned);
+		if (err)
+		{
+			std::cerr << "[Kafka] " << (pause ? "pause" : "resume") << " failed: " << rd_kafka_err2str(err) << std::endl;
+			return;
+		}
+		paused_ = pause;
+		pausedGauge_.set(pause ? 1 : 0);
+		std::cout << "[Kafka] " << (pause ? "Paused" : "Resumed") << " consumption, in-flight: " << tracker_->inFlight() << std::endl;
+	}
+
+	static void rebalanceCb(rd_kafka_t *rk, rd_kafka_resp_err_t err,
+							rd_kafka_topic_partition_list_t *partitions, void *opaque)
+	{
+		KafkaConsumer *self = static_cast<KafkaConsumer *>(opaque);
+		if (err == RD_KAFKA_RESP_ERR__ASSIGN_PARTITIONS)
+		{
+			self->generation_ = self->tracker_->reset();
+			self->paused_ = false;
+			self->pausedGauge_.set(0);
+			rd_kafka_assign(rk, partitions);
+		}
+		else
+		{
+			// 交出分区前提交已完成的部分；仍在处理中的消息会被新的持有者重新消费
+			self->commit(false);
+			self->generation_ = self->tracker_->reset();
+			self->paused_ = false;
+			self->pausedGauge_.set(0);
+			rd_kafka_assign(rk, nullptr);
+		}
+	}
+
 	KafkaConfig cfg_;
 	EmailService &emailSvc_;
 	rd_kafka_t *rk_ = nullptr;
+	rd_kafka_queue_t *queue_ = nullptr;
+	std::shared_ptr<OffsetTracker> tracker_ = std::make_shared<OffsetTracker>();
+	uint64_t generation_ = 0;
+	bool paused_ = false;
+	std::atomic<bool> restart_{false};
+
+	metrics::Counter &consumed_ = metrics::Registry::instance().counter(
+		"email_kafka_messages_total", "Email task messages consumed from Kafka");
+	metrics::LatencyHistogram &enqueueWait_ = EmailMetrics::instance().stage("enqueue");
+	metrics::Gauge &pausedGauge_ = metrics::Registry::instance().gauge(
+		"email_kafka_paused", "1 while consumption is paused for backpressure");
+	metrics::Gauge &lagTotal_ = metrics::Registry::instance().gauge(
+		"email_kafka_consumer_lag_total", "Messages behind the high watermark across assigned partitions");
 };
 
-#endif // !KAFKACONSUMER_H
\ No newline at end of file
+#endif // !KAFKACONSUMER_H
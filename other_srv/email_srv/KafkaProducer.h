@@ -1,96 +1,265 @@
 #pragma once
 #include <librdkafka/rdkafkacpp.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <iostream>
 #include <mutex>
+#include <thread>
 
+// 进程级 Kafka 生产者
+// 启动时 start() 一次：建立 broker 连接，并起一个专用线程 poll 投递回调；配置变更时 restart() 换一代实例；
+// 请求路径上的 send() 只把消息放进 librdkafka 的有界内部队列，队列满时立即返回 kQueueFull，不阻塞也不建连。
+// 消息由 librdkafka 按 linger.ms / batch.num.messages 攒批、压缩后发送；退出前 stop() 把队列冲刷完。
+// 开启幂等生产（acks=all，重试不乱序不重复）；带 key 的消息按 key 固定分区，同一邮箱的消息落在同一分区。
 class KafkaProducer : public RdKafka::DeliveryReportCb
 {
 public:
+	struct Options
+	{
+		int lingerMs = 5;				  // 攒批等待时间
+		int batchNumMessages = 1000;	  // 单批最大消息数
+		int queueMaxMessages = 100000;	  // 进程内待发送队列上限，超过即背压
+		int queueMaxKbytes = 64 * 1024;	  // 进程内待发送队列字节上限（KB）
+		int messageTimeoutMs = 30000;	  // 单条消息最长投递时间
+		std::string compression = "lz4"; // none / lz4 / zstd / snappy / gzip
+		bool idempotence = true;
+	};
+
+	// 投递结果观察者（在 poll 线程中调用），latencyUs 为入队到收到投递报告的耗时
+	using DeliveryObserver = std::function<void(const std::string &topic, RdKafka::ErrorCode err, int64_t latencyUs)>;
+
+	enum class SendResult
+	{
+		kOk,
+		kQueueFull,	 // 队列已满，调用方应快速失败（503/429）
+		kNotStarted, // 尚未 start() 或已 stop()
+		kError,
+	};
+
 	static KafkaProducer &instance()
 	{
 		static KafkaProducer inst;
 		return inst;
 	}
 
-	bool init(const std::string &brokers)
-	{
-		std::string errstr;
+	bool start(const std::string &brokers) { return start(brokers, Options()); }
 
-		RdKafka::Conf *conf = RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL);
-		RdKafka::Conf *tconf = RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC);
+	bool start(const std::string &brokers, const Options &opts)
+	{
+		std::lock_guard<std::mutex> lock(lifecycleMutex_);
+		if (std::atomic_load(&current_))
+			return true;
+		auto gen = create(brokers, opts);
+		if (!gen)
+			return false;
+		std::atomic_store(&current_, gen);
+		return true;
+	}
 
-		// 设置 broker 列表
-		if (conf->set("bootstrap.servers", brokers, errstr) != RdKafka::Conf::CONF_OK)
+	// 配置热更新：先建好新连接再整体替换，请求路径随即切到新实例；
+	// 旧实例在 timeoutMs 内把已入队的消息发完后销毁。新实例创建失败时保留旧的
+	bool restart(const std::string &brokers, const Options &opts, int timeoutMs = 5000)
+	{
+		std::shared_ptr<Generation> old;
 		{
-			std::cerr << "Kafka conf error: " << errstr << std::endl;
-			return false;
+			std::lock_guard<std::mutex> lock(lifecycleMutex_);
+			auto gen = create(brokers, opts);
+			if (!gen)
+				return false;
+			old = std::atomic_exchange(&current_, gen);
 		}
+		retire(std::move(old), timeoutMs);
+		return true;
+	}
 
-		// 设置 delivery 回调
-		if (conf->set("dr_cb", this, errstr) != RdKafka::Conf::CONF_OK)
+	// 停止 poll 线程并在 timeoutMs 内把队列中的消息发完
+	void stop(int timeoutMs = 5000)
+	{
+		std::shared_ptr<Generation> old;
 		{
-			std::cerr << "Kafka set dr_cb error: " << errstr << std::endl;
-			return false;
+			std::lock_guard<std::mutex> lock(lifecycleMutex_);
+			old = std::atomic_exchange(&current_, std::shared_ptr<Generation>());
 		}
+		retire(std::move(old), timeoutMs);
+	}
 
-		producer_.reset(RdKafka::Producer::create(conf, errstr));
-		if (!producer_)
-		{
-			std::cerr << "Kafka producer create failed: " << errstr << std::endl;
+	// 探测 broker 是否可达（拉一次集群元数据），用于启动就绪判断；不影响已入队的消息
+	bool probe(int timeoutMs)
+	{
+		auto gen = std::atomic_load(&current_);
+		if (!gen)
 			return false;
-		}
+		RdKafka::Metadata *md = nullptr;
+		RdKafka::ErrorCode err = gen->producer->metadata(false, nullptr, &md, timeoutMs);
+		delete md;
+		return err == RdKafka::ERR_NO_ERROR;
+	}
 
-		std::cout << "Kafka Producer initialized: " << brokers << std::endl;
+	// 注册投递结果观察者，须在 start() 之前调用
+	void setDeliveryObserver(DeliveryObserver observer) { observer_ = std::move(observer); }
 
-		delete conf;
-		delete tconf;
-		return true;
+	// 异步发送消息：只入队，不等待投递
+	SendResult send(const std::string &topic, const std::string &msg)
+	{
+		return send(topic, std::string(), std::string(msg));
 	}
 
-	// 异步发送消息
-	bool send(const std::string &topic, const std::string &msg)
+	// key 非空时按 key 分区；payload 移交给在途消息持有，librdkafka 直接引用其内存，不再复制
+	SendResult send(const std::string &topic, std::string key, std::string payload)
 	{
-		if (!producer_)
-			return false;
+		auto gen = std::atomic_load(&current_);
+		if (!gen)
+			return SendResult::kNotStarted;
 
-		RdKafka::ErrorCode err = producer_->produce(
+		auto *inflight = new InFlight{std::move(key), std::move(payload), std::chrono::steady_clock::now()};
+		RdKafka::ErrorCode err = gen->producer->produce(
 			topic,
 			RdKafka::Topic::PARTITION_UA,
-			RdKafka::Producer::RK_MSG_COPY /*复制消息*/,
-			(void *)msg.data(), msg.size(),
-			nullptr, 0,
+			0 /*不复制也不由 librdkafka 释放，内存随 InFlight 在 dr_cb 中回收*/,
+			inflight->payload.data(), inflight->payload.size(),
+			inflight->key.empty() ? nullptr : inflight->key.data(), inflight->key.size(),
 			0,
-			nullptr);
+			inflight);
 
-		if (err != RdKafka::ERR_NO_ERROR)
-		{
-			std::cerr << "Kafka produce error: " << RdKafka::err2str(err) << std::endl;
-			return false;
-		}
+		if (err == RdKafka::ERR_NO_ERROR)
+			return SendResult::kOk;
 
-		// 触发回调
-		producer_->poll(0);
-		return true;
+		// 入队失败时 librdkafka 不会再引用这条消息
+		delete inflight;
+		if (err == RdKafka::ERR__QUEUE_FULL)
+			return SendResult::kQueueFull;
+		std::cerr << "Kafka produce error: " << RdKafka::err2str(err) << std::endl;
+		return SendResult::kError;
 	}
 
-	// delivery 回调
+	// delivery 回调（在 poll 线程中执行）
 	void dr_cb(RdKafka::Message &msg) override
 	{
+		std::unique_ptr<InFlight> inflight(static_cast<InFlight *>(msg.msg_opaque()));
 		if (msg.err())
-		{
 			std::cerr << " Delivery failed: " << msg.errstr() << std::endl;
-		}
-		else
+		if (observer_ && inflight)
 		{
-			std::cout << "Delivered message to "
-					  << msg.topic_name() << " [" << msg.partition() << "]"
-					  << std::endl;
+			auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+							   std::chrono::steady_clock::now() - inflight->enqueuedAt)
+							   .count();
+			observer_(msg.topic_name(), msg.err(), latency);
 		}
 	}
 
+	~KafkaProducer() override { stop(); }
+
 private:
+	// 在途消息：key / payload 的内存必须存活到投递报告返回
+	struct InFlight
+	{
+		std::string key;
+		std::string payload;
+		std::chrono::steady_clock::time_point enqueuedAt;
+	};
+
+	// 一代生产者实例：librdkafka 句柄 + 专用 poll 线程，热更新时整体替换
+	struct Generation
+	{
+		std::unique_ptr<RdKafka::Producer> producer;
+		std::atomic<bool> polling{true};
+		std::thread pollThread;
+		std::string brokers;
+		std::promise<void> released; // 最后一个 shared_ptr 释放时置位，见 create()
+	};
+
 	KafkaProducer() = default;
-	std::unique_ptr<RdKafka::Producer> producer_;
+
+	std::shared_ptr<Generation> create(const std::string &brokers, const Options &opts)
+	{
+		std::string errstr;
+		std::unique_ptr<RdKafka::Conf> conf(RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
+
+		const std::pair<const char *, std::string> settings[] = {
+			{"bootstrap.servers", brokers},
+			{"linger.ms", std::to_string(opts.lingerMs)},
+			{"batch.num.messages", std::to_string(opts.batchNumMessages)},
+			{"queue.buffering.max.messages", std::to_string(opts.queueMaxMessages)},
+			{"queue.buffering.max.kbytes", std::to_string(opts.queueMaxKbytes)},
+			{"message.timeout.ms", std::to_string(opts.messageTimeoutMs)},
+			{"compression.type", opts.compression},
+			{"enable.idempotence", opts.idempotence ? "true" : "false"},
+		};
+		for (const auto &kv : settings)
+		{
+			if (conf->set(kv.first, kv.second, errstr) != RdKafka::Conf::CONF_OK)
+			{
+				std::cerr << "Kafka conf " << kv.first << " error: " << errstr << std::endl;
+				return nullptr;
+			}
+		}
+
+		// 设置 delivery 回调
+		if (conf->set("dr_cb", this, errstr) != RdKafka::Conf::CONF_OK)
+		{
+			std::cerr << "Kafka set dr_cb error: " << errstr << std::endl;
+			return nullptr;
+		}
+
+		auto gen = std::make_unique<Generation>();
+		gen->brokers = brokers;
+		gen->producer.reset(RdKafka::Producer::create(conf.get(), errstr));
+		if (!gen->producer)
+		{
+			std::cerr << "Kafka producer create failed: " << errstr << std::endl;
+			return nullptr;
+		}
+
+		Generation *g = gen.get();
+		gen->pollThread = std::thread([g]
+									  {
+			// 投递回调只在这个线程里触发，请求线程不再 poll
+			while (g->polling.load(std::memory_order_acquire))
+				g->producer->poll(100); });
+
+		std::cout << "Kafka Producer started: " << brokers << std::endl;
+		// 删除器只发信号：请求线程放手时不在请求路径上停线程、冲刷，由 retire() 接管销毁
+		return std::shared_ptr<Generation>(gen.release(), [](Generation *g)
+										   { g->released.set_value(); });
+	}
+
+	// 已从 current_ 摘下的实例：等仍在 produce 的请求线程放手，再停 poll 线程并冲刷队列。
+	// 在 lifecycleMutex_ 之外调用
+	void retire(std::shared_ptr<Generation> ptr, int timeoutMs)
+	{
+		if (!ptr)
+			return;
+		std::unique_ptr<Generation> gen(ptr.get());
+		std::future<void> released = gen->released.get_future();
+		ptr.reset();
+		released.wait();
+
+		gen->polling.store(false, std::memory_order_release);
+		if (gen->pollThread.joinable())
+			gen->pollThread.join();
+
+		if (gen->producer->flush(timeoutMs) != RdKafka::ERR_NO_ERROR)
+		{
+			std::cerr << "Kafka flush timed out, " << gen->producer->outq_len() << " message(s) dropped" << std::endl;
+			// 清掉剩余消息并让它们的投递报告（ERR__PURGE_*）回来，释放在途内存；
+			// 报告不一定一次 poll 就全部回来，轮询到队列清空或超过期限
+			gen->producer->purge(RdKafka::Producer::PURGE_QUEUE | RdKafka::Producer::PURGE_INFLIGHT);
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kPurgeDrainMs);
+			while (gen->producer->outq_len() > 0 && std::chrono::steady_clock::now() < deadline)
+				gen->producer->poll(100);
+			if (gen->producer->outq_len() > 0)
+				std::cerr << "Kafka purge incomplete, " << gen->producer->outq_len() << " message(s) not reported" << std::endl;
+		}
+		std::cout << "Kafka Producer retired: " << gen->brokers << std::endl;
+	}
+
+	static constexpr int kPurgeDrainMs = 2000; // purge 后等待投递报告回收在途内存的上限
+
+	DeliveryObserver observer_;
+	std::mutex lifecycleMutex_;
+	std::shared_ptr<Generation> current_; // 经 std::atomic_load / atomic_store 访问
 };
@@ -0,0 +1,193 @@
+// 线程池基准：WorkStealingPool vs 原先的单 mutex + condvar 队列
+// 用法：pool_bench [rate=0] [seconds=3] [work_us=20] [workers=1,2,4,8] [capacity=4096]
+//   rate     每秒提交的任务数，0 表示尽力提交（测饱和吞吐）
+//   work_us  每个任务模拟的处理耗时（忙等）
+//   capacity 两种实现的总排队容量，工作窃取池按 worker 均分（每个队列向下取 2 的幂）
+// 输出每种实现、每个 worker 数下的实际总容量、吞吐和排队延迟（入队到开始执行）的平均值 / p99
+#include "workstealingpool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchTask
+{
+    Clock::time_point enqueuedAt;
+};
+
+// 原 EmailService 的执行器：一把锁 + 一个 std::queue，入队拷贝。
+// 构造参数与 WorkStealingPool 同口径（每个 worker 的容量），总容量 = workers × queueCapacityPerWorker
+class MutexPool
+{
+public:
+    using Handler = std::function<void(BenchTask &&)>;
+
+    MutexPool(size_t workers, size_t queueCapacityPerWorker, Handler handler)
+        : capacity_(workers * queueCapacityPerWorker), handler_(std::move(handler))
+    {
+        for (size_t i = 0; i < workers; ++i)
+            threads_.emplace_back([this]
+                                  {
+                for (;;)
+                {
+                    BenchTask task;
+                    {
+                        std::unique_lock<std::mutex> lk(mtx_);
+                        cv_.wait(lk, [this] { return stop_ || !tasks_.empty(); });
+                        if (tasks_.empty())
+                            return;
+                        task = tasks_.front();
+                        tasks_.pop();
+                    }
+                    handler_(std::move(task));
+                } });
+    }
+
+    ~MutexPool() { stop(); }
+
+    bool submit(BenchTask &&task)
+    {
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            if (tasks_.size() >= capacity_)
+                return false;
+            tasks_.push(task);
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    void stop()
+    {
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            if (stop_)
+                return;
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &t : threads_)
+            t.join();
+    }
+
+private:
+    size_t capacity_;
+    Handler handler_;
+    std::vector<std::thread> threads_;
+    std::queue<BenchTask> tasks_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+// 每个执行线程各自记录，避免统计本身成为争用点
+struct alignas(64) LatencySink
+{
+    std::vector<uint32_t> samplesNs;
+};
+
+static void busyWait(int us)
+{
+    auto until = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < until)
+    {
+    }
+}
+
+// 总容量均分到每个 worker，向下取 2 的幂：BoundedMpmcQueue 会向上取整，取下界保证两边总容量一致且不超过 capacity
+static size_t perWorkerCapacity(size_t capacity, size_t workers)
+{
+    size_t target = std::max<size_t>(1, capacity / std::max<size_t>(1, workers));
+    size_t cap = 1;
+    while (cap * 2 <= target)
+        cap <<= 1;
+    return cap;
+}
+
+template <typename Pool>
+static void runOne(const char *name, size_t workers, size_t capacity, int rate, int seconds, int workUs)
+{
+    const size_t perWorker = perWorkerCapacity(capacity, workers);
+
+    std::vector<LatencySink> sinks(workers + 1);
+    std::atomic<size_t> nextSink{0};
+    std::atomic<uint64_t> done{0};
+
+    auto handler = [&](BenchTask &&task)
+    {
+        thread_local size_t sink = nextSink.fetch_add(1) % sinks.size();
+        auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - task.enqueuedAt).count();
+        sinks[sink].samplesNs.push_back(static_cast<uint32_t>(std::min<int64_t>(waited, UINT32_MAX)));
+        busyWait(workUs);
+        done.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    uint64_t submitted = 0, rejected = 0;
+    auto start = Clock::now();
+    {
+        Pool pool(workers, perWorker, handler);
+        auto deadline = start + std::chrono::seconds(seconds);
+        auto interval = rate > 0 ? std::chrono::nanoseconds(1000000000LL / rate) : std::chrono::nanoseconds(0);
+        auto next = start;
+        while (Clock::now() < deadline)
+        {
+            if (rate > 0)
+            {
+                while (Clock::now() < next)
+                {
+                }
+                next += interval;
+            }
+            if (pool.submit(BenchTask{Clock::now()}))
+                ++submitted;
+            else
+                ++rejected;
+        }
+        pool.stop();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint32_t> all;
+    for (auto &s : sinks)
+        all.insert(all.end(), s.samplesNs.begin(), s.samplesNs.end());
+    std::sort(all.begin(), all.end());
+    double avgUs = 0;
+    for (auto v : all)
+        avgUs += v / 1000.0;
+    avgUs = all.empty() ? 0 : avgUs / all.size();
+    double p99Us = all.empty() ? 0 : all[std::min(all.size() - 1, all.size() * 99 / 100)] / 1000.0;
+
+    std::printf("%-14s workers=%-3zu capacity=%-6zu done=%-10llu rejected=%-10llu throughput=%12.0f/s  queue_wait avg=%9.1fus p99=%9.1fus\n",
+                name, workers, perWorker * workers, (unsigned long long)done.load(), (unsigned long long)rejected,
+                done.load() / elapsed, avgUs, p99Us);
+}
+
+int main(int argc, char *argv[])
+{
+    int rate = argc > 1 ? std::atoi(argv[1]) : 0;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+    int workUs = argc > 3 ? std::atoi(argv[3]) : 20;
+    std::vector<size_t> workerCounts;
+    std::stringstream ss(argc > 4 ? argv[4] : "1,2,4,8");
+    for (std::string item; std::getline(ss, item, ',');)
+        workerCounts.push_back(static_cast<size_t>(std::atoi(item.c_str())));
+    size_t capacity = argc > 5 ? static_cast<size_t>(std::atoll(argv[5])) : 4096;
+
+    std::printf("rate=%s seconds=%d work_us=%d\n", rate > 0 ? std::to_string(rate).c_str() : "max", seconds, workUs);
+    for (size_t n : workerCounts)
+    {
+        runOne<WorkStealingPool<BenchTask>>("work-stealing", n, capacity, rate, seconds, workUs);
+        runOne<MutexPool>("mutex-queue", n, capacity, rate, seconds, workUs);
+    }
+    return 0;
+}
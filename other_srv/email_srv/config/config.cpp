@@ -1,8 +1,82 @@
 #include "config.h"
+#include <memory>
+#include <mutex>
+#include <vector>
 
 using json = nlohmann::json;
 using namespace nacos;
 
+namespace
+{
+	// 已发布的全部快照；只在发布时追加，读者可能仍持有任意一份的引用
+	std::mutex g_publishMutex;
+	std::vector<std::unique_ptr<const AppConfig>> g_snapshots;
+	std::vector<std::pair<int, ConfigSubscriber>> g_subscribers;
+	int g_nextSubscriberId = 0;
+
+	const AppConfig *initialSnapshot()
+	{
+		g_snapshots.emplace_back(new AppConfig());
+		return g_snapshots.back().get();
+	}
+}
+
+std::atomic<const AppConfig *> AppConfig::current_{initialSnapshot()};
+
+const AppConfig &AppConfig::publish(AppConfig next)
+{
+	std::lock_guard<std::mutex> lock(g_publishMutex);
+	const AppConfig *prev = current_.load(std::memory_order_acquire);
+	g_snapshots.emplace_back(new AppConfig(std::move(next)));
+	const AppConfig *cur = g_snapshots.back().get();
+	current_.store(cur, std::memory_order_release);
+	for (auto &sub : g_subscribers)
+	{
+		try
+		{
+			sub.second(*prev, *cur);
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << "[Config] subscriber " << sub.first << " failed: " << e.what() << std::endl;
+		}
+	}
+	return *cur;
+}
+
+int SubscribeConfig(ConfigSubscriber subscriber, const AppConfig *basis)
+{
+	std::lock_guard<std::mutex> lock(g_publishMutex);
+	// 在发布锁内补发：与发布线程互斥，basis 之后的快照恰好送达一次
+	const AppConfig *cur = &AppConfig::getInstance();
+	if (basis && basis != cur)
+	{
+		try
+		{
+			subscriber(*basis, *cur);
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << "[Config] subscriber " << g_nextSubscriberId + 1 << " failed: " << e.what() << std::endl;
+		}
+	}
+	g_subscribers.emplace_back(++g_nextSubscriberId, std::move(subscriber));
+	return g_nextSubscriberId;
+}
+
+void UnsubscribeConfig(int id)
+{
+	std::lock_guard<std::mutex> lock(g_publishMutex);
+	for (auto it = g_subscribers.begin(); it != g_subscribers.end(); ++it)
+	{
+		if (it->first == id)
+		{
+			g_subscribers.erase(it);
+			return;
+		}
+	}
+}
+
 class ConfigListener : public Listener
 {
 public:
@@ -19,23 +93,72 @@ public:
 		{
 			auto j = json::parse(content);
 
-			AppConfig &cfg = AppConfig::getInstance();
+			// 在当前快照的副本上修改，解析完整成功后才整体发布；中途失败不影响正在使用的配置
+			AppConfig cfg = AppConfig::getInstance();
 			cfg.kafka.brokers = j["kafka"]["brokers"];
 			cfg.kafka.topic = j["kafka"]["topic"];
 			cfg.kafka.group_id = j["kafka"]["group_id"];
+			cfg.kafka.batch_size = j["kafka"].value("batch_size", cfg.kafka.batch_size);
+			cfg.kafka.max_in_flight = j["kafka"].value("max_in_flight", cfg.kafka.max_in_flight);
+			cfg.kafka.commit_interval_ms = j["kafka"].value("commit_interval_ms", cfg.kafka.commit_interval_ms);
+			cfg.kafka.dlq_topic = j["kafka"].value("dlq_topic", cfg.kafka.dlq_topic);
+			cfg.kafka.shutdown_drain_ms = j["kafka"].value("shutdown_drain_ms", cfg.kafka.shutdown_drain_ms);
 
 			cfg.redis.host = j["redis"]["host"];
 			cfg.redis.port = j["redis"]["port"];
-
-			cfg.smtp.url = j["smtp"]["url"];
-			cfg.smtp.user = j["smtp"]["user"];
-			cfg.smtp.pass = j["smtp"]["pass"];
+			cfg.redis.async = j["redis"].value("async", cfg.redis.async);
+			cfg.redis.pool_min = j["redis"].value("pool_min", cfg.redis.pool_min);
+			cfg.redis.pool_max = j["redis"].value("pool_max", cfg.redis.pool_max);
+			cfg.redis.checkout_timeout_ms = j["redis"].value("checkout_timeout_ms", cfg.redis.checkout_timeout_ms);
+			cfg.redis.connect_timeout_ms = j["redis"].value("connect_timeout_ms", cfg.redis.connect_timeout_ms);
+			cfg.redis.command_timeout_ms = j["redis"].value("command_timeout_ms", cfg.redis.command_timeout_ms);
+			cfg.redis.health_interval_ms = j["redis"].value("health_interval_ms", cfg.redis.health_interval_ms);
+			cfg.redis.idle_timeout_ms = j["redis"].value("idle_timeout_ms", cfg.redis.idle_timeout_ms);
+
+			cfg.smtp.url = j["smtp"].value("url", "");
+			cfg.smtp.user = j["smtp"].value("user", "");
+			cfg.smtp.pass = j["smtp"].value("pass", "");
 			cfg.smtp.from = j["smtp"]["from"];
 			cfg.smtp.from_name = j["smtp"]["from_name"];
+			cfg.smtp.transport_threads = j["smtp"].value("transport_threads", cfg.smtp.transport_threads);
+			cfg.smtp.max_concurrent_per_thread = j["smtp"].value("max_concurrent_per_thread", cfg.smtp.max_concurrent_per_thread);
+			cfg.smtp.relay_window_sec = j["smtp"].value("relay_window_sec", cfg.smtp.relay_window_sec);
+			cfg.smtp.relay_min_requests = j["smtp"].value("relay_min_requests", cfg.smtp.relay_min_requests);
+			cfg.smtp.relay_error_threshold_pct = j["smtp"].value("relay_error_threshold_pct", cfg.smtp.relay_error_threshold_pct);
+			cfg.smtp.relay_open_ms = j["smtp"].value("relay_open_ms", cfg.smtp.relay_open_ms);
+			cfg.smtp.relays.clear();
+			if (j["smtp"].contains("relays"))
+			{
+				for (const auto &r : j["smtp"]["relays"])
+				{
+					SmtpRelayConfig relay;
+					relay.url = r["url"];
+					relay.user = r.value("user", cfg.smtp.user);
+					relay.pass = r.value("pass", cfg.smtp.pass);
+					relay.weight = r.value("weight", relay.weight);
+					relay.max_concurrent = r.value("max_concurrent", relay.max_concurrent);
+					cfg.smtp.relays.push_back(relay);
+				}
+			}
+			// 旧配置只有一个 url：当作权重 1、不限并发的单个中继
+			if (cfg.smtp.relays.empty() && !cfg.smtp.url.empty())
+				cfg.smtp.relays.push_back(SmtpRelayConfig{cfg.smtp.url, cfg.smtp.user, cfg.smtp.pass, 1, 0});
 
 			cfg.email.code_ttl_sec = j["email"]["code_ttl_sec"];
 			cfg.email.dedup_ttl_sec = j["email"]["dedup_ttl_sec"];
-
+			cfg.email.min_remaining_sec = j["email"].value("min_remaining_sec", cfg.email.min_remaining_sec);
+			cfg.email.retry_max_attempts = j["email"].value("retry_max_attempts", cfg.email.retry_max_attempts);
+			cfg.email.retry_base_ms = j["email"].value("retry_base_ms", cfg.email.retry_base_ms);
+			cfg.email.retry_max_ms = j["email"].value("retry_max_ms", cfg.email.retry_max_ms);
+			cfg.email.subject_template = j["email"].value("subject_template", cfg.email.subject_template);
+			cfg.email.text_template = j["email"].value("text_template", cfg.email.text_template);
+			cfg.email.html_template = j["email"].value("html_template", cfg.email.html_template);
+
+			cfg.worker_threads = j.value("worker_threads", cfg.worker_threads);
+			cfg.queue_capacity = j.value("queue_capacity", cfg.queue_capacity);
+			cfg.metrics_port = j.value("metrics_port", cfg.metrics_port);
+
+			AppConfig::publish(std::move(cfg));
 			std::cout << "[Nacos] Config parsed successfully\n";
 		}
 		catch (std::exception &e)
@@ -55,12 +178,11 @@ void InitAppConfig()
 	props[PropertyKeyConst::AUTH_USERNAME] = "nacos";
 	props[PropertyKeyConst::AUTH_PASSWORD] = "nacos";
 	// 2. 正确的工厂（旧版 API）
-	INacosServiceFactory *factory = NacosFactoryFactory::getNacosFactory(props);
-	ResourceGuard<INacosServiceFactory> guardFactory(factory);
+	// factory / ConfigService 与进程同寿命：监听器要一直收到推送，不能在函数返回时析构
+	static INacosServiceFactory *factory = NacosFactoryFactory::getNacosFactory(props);
 
 	// 3. 创建 ConfigService
-	ConfigService *configSvc = factory->CreateConfigService();
-	ResourceGuard<ConfigService> guardConfig(configSvc);
+	static ConfigService *configSvc = factory->CreateConfigService();
 
 	// 4. 监听配置
 	ConfigListener *listener = new ConfigListener();
@@ -1,6 +1,7 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <atomic>
 #include <string>
 #include "Nacos.h"
 #include <nlohmann/json.hpp>
@@ -8,21 +9,48 @@
 #include "../log/Logger.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <functional>
+#include <vector>
 using  std::string;
 
+struct SmtpRelayConfig
+{
+    string url;
+    string user;
+    string pass;
+    int weight = 1;         // 平滑加权轮询的权重
+    int max_concurrent = 0; // 该中继全局并发上限，<= 0 不限
+};
+
 struct SmtpConfig
 {
+    // 单中继写法（兼容旧配置）；配置了 relays 时以 relays 为准
     string url;
     string user;
     string pass;
-    string from;
+    string from; // 所有中继共用的发件地址
     string from_name;
+    int transport_threads = 2;         // SMTP 驱动线程数
+    int max_concurrent_per_thread = 8; // 每个驱动线程的并发发送数 / 连接数
+    std::vector<SmtpRelayConfig> relays;
+    int relay_window_sec = 10;          // 中继错误率统计窗口
+    int relay_min_requests = 10;        // 窗口内请求数不足时不熔断
+    int relay_error_threshold_pct = 50; // 暂时性错误占比达到即熔断
+    int relay_open_ms = 15000;          // 熔断持续时间
 };
 
 struct RedisConfig
 {
     string host;
     int port;
+    bool async = true; // 使用 hiredis 异步连接 + 事件循环，worker 不阻塞在 Redis 上
+    int pool_min = 2;               // 同步连接池常驻连接数
+    int pool_max = 8;               // 同步连接池上限
+    int checkout_timeout_ms = 200;  // 借连接最长等待
+    int connect_timeout_ms = 500;
+    int command_timeout_ms = 1000;
+    int health_interval_ms = 5000;  // 空闲连接 PING 周期
+    int idle_timeout_ms = 60000;    // 超过 min 的空闲连接多久后回收
 };
 
 struct KafkaConfig
@@ -30,14 +58,30 @@ struct KafkaConfig
     string brokers;
     string topic;
     string group_id;
+    int batch_size = 100;          // 单次 consume_batch 的最大消息数
+    int max_in_flight = 1000;      // 在途任务高水位，超过即暂停消费，降到一半恢复
+    int commit_interval_ms = 1000; // 周期提交间隔
+    string dlq_topic = "email_dlq"; // 永久失败邮件的死信 topic，为空则不写
+    int shutdown_drain_ms = 20000;  // 停机时等待在途任务完成的上限，超时未完成的留给重投
 };
 
 struct EmailBizConfig
 {
     int code_ttl_sec;
     int dedup_ttl_sec;
+    int min_remaining_sec = 10; // 预计送达时验证码剩余有效期不足该值则不再发送
+    int retry_max_attempts = 4;  // 含首次发送的最大尝试次数
+    int retry_base_ms = 1000;    // 首次重试的退避基数
+    int retry_max_ms = 30000;    // 退避上限
+    // 验证码邮件模板，可用变量：{{code}} {{ttl_min}} {{email}}；html_template 为空时只发纯文本
+    string subject_template = "您的 CloudDisk 登录验证码";
+    string text_template = "您的验证码为: {{code}}\n有效期 {{ttl_min}} 分钟，请勿泄露。";
+    string html_template;
 };
 
+// 配置快照：每次 Nacos 推送解析成一份新的 AppConfig，整体替换当前指针（RCU 风格）
+// - 读：getInstance() 只有一次 acquire load，不加锁；拿到的引用指向不可变快照，始终有效
+// - 写：只有 Nacos 回调线程发布，旧快照不释放（配置变更很少），读者无需宽限期
 class AppConfig
 {
 public:
@@ -45,21 +89,27 @@ public:
     RedisConfig redis;
     KafkaConfig kafka;
     EmailBizConfig email;
-    int worker_threads;
-	/// ---- 单例全局访问接口 ----
-	static AppConfig &getInstance()
+    int worker_threads = 8;
+    int queue_capacity = 1024; // 每个 worker 队列的容量
+    int metrics_port = 9464;   // /metrics 监听端口，0 关闭
+	/// ---- 当前快照 ----
+	static const AppConfig &getInstance()
 	{
-		static AppConfig instance; // C++11 线程安全
-		return instance;
+		return *current_.load(std::memory_order_acquire);
 	}
 
-private:
-	AppConfig() = default;
-	~AppConfig() = default;
+	// 发布新快照并依次通知订阅者，返回发布后的快照
+	static const AppConfig &publish(AppConfig next);
 
-	AppConfig(const AppConfig &) = delete;
-	AppConfig &operator=(const AppConfig &) = delete;
+private:
+	static std::atomic<const AppConfig *> current_;
 };
 void InitAppConfig(void);
+// 订阅配置变更：每次从 Nacos 解析出新快照并发布后，在发布线程中按注册顺序调用（包括首次加载），
+// prev 为替换前的快照；返回订阅号，供 UnsubscribeConfig 使用（不能在回调中退订）
+// basis 为订阅方初始化时所用的快照：不是当前快照时，先在发布锁内以 (basis, 当前) 调用一次补上期间的推送
+using ConfigSubscriber = std::function<void(const AppConfig &prev, const AppConfig &next)>;
+int SubscribeConfig(ConfigSubscriber subscriber, const AppConfig *basis = nullptr);
+void UnsubscribeConfig(int id);
 
 #endif // !CONFIG_H
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef DEADLETTER_H
+#define DEADLETTER_H
+
+#include "config/config.h"
+#include <librdkafka/rdkafka.h>
+#include <atomic>
+#include <thread>
+
+// ============ 死信生产者 ============
+// 永久失败（重试耗尽 / 5xx / 已过期）的邮件写入死信 topic，供人工排查或离线补发。
+// 消息量很小，不攒批；专用线程 poll 投递回调，发送路径只入队。
+class DeadLetterProducer
+{
+public:
+    DeadLetterProducer(const string &brokers, const string &topic)
+        : topic_(topic)
+    {
+        if (topic_.empty())
+            return;
+
+        char errstr[512];
+        rd_kafka_conf_t *conf = rd_kafka_conf_new();
+        if (rd_kafka_conf_set(conf, "bootstrap.servers", brokers.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
+        {
+            rd_kafka_conf_destroy(conf);
+            std::cerr << "[DLQ] Failed to set bootstrap.servers: " << errstr << std::endl;
+            return;
+        }
+        rd_kafka_conf_set(conf, "enable.idempotence", "true", nullptr, 0);
+        rd_kafka_conf_set_dr_msg_cb(conf, &DeadLetterProducer::deliveryCb);
+
+        rk_ = rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr, sizeof(errstr));
+        if (!rk_)
+        {
+            std::cerr << "[DLQ] Failed to create producer: " << errstr << std::endl;
+            return;
+        }
+        running_.store(true);
+        pollThread_ = std::thread([this]
+                                  {
+            while (running_.load())
+                rd_kafka_poll(rk_, 100); });
+    }
+
+    ~DeadLetterProducer()
+    {
+        if (!rk_)
+            return;
+        running_.store(false);
+        if (pollThread_.joinable())
+            pollThread_.join();
+        if (rd_kafka_flush(rk_, 5000) != RD_KAFKA_RESP_ERR_NO_ERROR)
+            std::cerr << "[DLQ] Flush timed out, dead letters may be lost" << std::endl;
+        rd_kafka_destroy(rk_);
+    }
+
+    DeadLetterProducer(const DeadLetterProducer &) = delete;
+    DeadLetterProducer &operator=(const DeadLetterProducer &) = delete;
+
+    bool enabled() const { return rk_ != nullptr; }
+
+    // key 用收件地址，同一邮箱的死信落在同一分区
+    bool publish(const string &key, const string &payload)
+    {
+        if (!rk_)
+            return false;
+        rd_kafka_resp_err_t err = rd_kafka_producev(
+            rk_,
+            RD_KAFKA_V_TOPIC(topic_.c_str()),
+            RD_KAFKA_V_KEY(key.data(), key.size()),
+            RD_KAFKA_V_VALUE(const_cast<char *>(payload.data()), payload.size()),
+            RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY),
+            RD_KAFKA_V_END);
+        if (err)
+        {
+            std::cerr << "[DLQ] produce failed: " << rd_kafka_err2str(err) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static void deliveryCb(rd_kafka_t *, const rd_kafka_message_t *msg, void *)
+    {
+        if (msg->err)
+            std::cerr << "[DLQ] delivery failed: " << rd_kafka_err2str(msg->err) << std::endl;
+    }
+
+    string topic_;
+    rd_kafka_t *rk_ = nullptr;
+    std::atomic<bool> running_{false};
+    std::thread pollThread_;
+};
+
+#endif // !DEADLETTER_H
@@ -3,15 +3,22 @@
 
 #include "redispool.h"
 #include "emailsend.h"
+#include "emailtemplate.h"
+#include "deadletter.h"
+#include "timerwheel.h"
+#include "metrics.h"
+#include "workstealingpool.h"
 #include "config/config.h"
 #include <random>
 #include <chrono>
-#include <queue>
 #include <vector>
 #include <thread>
-#include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <algorithm>
+#include <tuple>
 
 // ============ 工具：生成验证码 ============
 string gen_code()
@@ -25,146 +32,579 @@ string gen_code()
     return string(buf);
 }
 
+// ============ 任务完成回执 ============
+// 最后一个持有者释放时触发一次：发送成功、失败、被去重跳过都算处理完成。
+// 异步发送时回执随回调一起被持有，直到 SMTP 结果返回。
+class TaskAck
+{
+public:
+    explicit TaskAck(std::function<void()> fn, std::function<void()> onAbandon = nullptr)
+        : fn_(std::move(fn)), onAbandon_(std::move(onAbandon)) {}
+    ~TaskAck()
+    {
+        if (fn_)
+            fn_();
+    }
+    TaskAck(const TaskAck &) = delete;
+    TaskAck &operator=(const TaskAck &) = delete;
+
+    // 停机时放弃：析构不再回执完成，消息留给重启后重投
+    void abandon()
+    {
+        fn_ = nullptr;
+        if (onAbandon_)
+            onAbandon_();
+        onAbandon_ = nullptr;
+    }
+
+private:
+    std::function<void()> fn_;
+    std::function<void()> onAbandon_;
+};
+
 // ============ 邮件任务 ============
+// 优先级即线程池通道号，数值越小越先处理
+enum class EmailPriority : size_t
+{
+    kVerification = 0, // 验证码：有时效，优先发送
+    kBulk = 1,         // 通知 / 重试等不紧急的邮件
+    kCount
+};
+
 struct EmailTask
 {
     string email;
+    std::shared_ptr<TaskAck> ack; // 可为空
+    EmailPriority priority = EmailPriority::kVerification;
+    int64_t enqueueMs = 0; // 用户发起请求的时间（Unix 毫秒，取 Kafka 消息时间戳），0 表示未知
+    int attempt = 0;       // 已失败的发送次数
+    string code;           // 非空表示重试：验证码已写入 Redis，直接重发
+    string token;          // 消息令牌（topic:partition:offset），重投时据此识别同一条消息
+    std::chrono::steady_clock::time_point queuedAt{}; // 进入线程池的时间，用于统计排队耗时
+};
+
+inline int64_t elapsedMicros(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+// ============ 邮件服务指标 ============
+// 阶段耗时：kafka（请求 → 被消费）、queue（入池 → 开始处理）、redis（去重写码）、smtp（发送）、
+// end_to_end（请求 → 送达）；任务结果按 result 计数
+struct EmailMetrics
+{
+    static EmailMetrics &instance()
+    {
+        static EmailMetrics m;
+        return m;
+    }
+
+    metrics::LatencyHistogram &stage(const char *name)
+    {
+        return metrics::Registry::instance().histogram(
+            "email_stage_seconds", "Latency of each email pipeline stage", string("stage=\"") + name + "\"");
+    }
+
+    metrics::Counter &result(const char *name)
+    {
+        return metrics::Registry::instance().counter(
+            "email_tasks_total", "Email tasks by final or intermediate outcome", string("result=\"") + name + "\"");
+    }
+
+    metrics::LatencyHistogram &kafkaStage = stage("kafka");
+    metrics::LatencyHistogram &queueStage = stage("queue");
+    metrics::LatencyHistogram &redisStage = stage("redis");
+    metrics::LatencyHistogram &smtpStage = stage("smtp");
+    metrics::LatencyHistogram &endToEnd = stage("end_to_end");
+
+    metrics::Counter &sent = result("sent");
+    metrics::Counter &duplicate = result("duplicate");
+    metrics::Counter &expired = result("expired");
+    metrics::Counter &retried = result("retried");
+    metrics::Counter &failed = result("failed");
+    metrics::Counter &redisError = result("redis_error");
+    metrics::Counter &redelivered = result("redelivered");
+    metrics::Counter &abandoned = result("left_for_redelivery");
+
+    metrics::Gauge &smtpInFlight = metrics::Registry::instance().gauge(
+        "email_smtp_in_flight", "Emails handed to the SMTP transport and not yet finished");
 };
 
+inline int64_t unixMillis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
 // ============ 邮件服务：线程池 + Redis + Sender ============
 class EmailService
 {
 public:
     EmailService(const AppConfig &cfg)
-        : cfg_(cfg),
-          redisPool_(cfg_.redis, 8),
-          sender_(cfg_.smtp),
-          stop_(false)
+        : redisPool_(makeRetirable<RedisPool>(cfg.redis)),
+          dlq_(makeRetirable<DeadLetterProducer>(cfg.kafka.brokers, cfg.kafka.dlq_topic)),
+          sender_(makeRetirable<EmailSender>(cfg.smtp)),
+          pool_(makePool(cfg))
     {
-        int n = cfg_.worker_threads > 0 ? cfg_.worker_threads : 8;
-        for (int i = 0; i < n; ++i)
-        {
-            workers_.emplace_back(&EmailService::workerLoop, this, i);
-        }
+        templates_.reload(cfg.smtp, cfg.email);
+        // Nacos 推送新快照时按变化重建组件；构造期间已有推送时订阅内补一次；析构时先退订
+        configSub_ = SubscribeConfig([this](const AppConfig &prev, const AppConfig &next)
+                                     { applyConfig(prev, next); },
+                                     &cfg);
+        registerGauges();
     }
 
     ~EmailService()
     {
-        stop_ = true;
-        cv_.notify_all();
-        for (auto &t : workers_)
-        {
-            if (t.joinable())
-                t.join();
-        }
+        UnsubscribeConfig(configSub_);
+        unregisterGauges();
+        // 走到这里时排空期（KafkaConsumer::drain）已经结束，剩下的任务都超过了期限：
+        // 等重试的、线程池里排队的、SMTP 未完成的一律不再处理，交给重启后的重投；
+        // 再停线程池（worker 取空队列），等 Redis 回调执行完（回调里会用到 sender），最后析构 sender / redis
+        retryWheel_.stop(false);
+        abandonQueued_.store(true, std::memory_order_release);
+        std::atomic_load(&sender_)->cancelPending();
+        std::atomic_load(&pool_)->stop();
+        std::atomic_load(&redisPool_)->stopAsync();
     }
 
-    void enqueue(const EmailTask &task)
+    // 按优先级进入对应通道；该通道所有 worker 队列都满时返回 false，由调用方稍后重试
+    bool enqueue(EmailTask &&task)
     {
-        {
-            std::unique_lock<std::mutex> lk(mtx_);
-            tasks_.push(task);
-        }
-        cv_.notify_one();
+        size_t lane = (size_t)task.priority;
+        task.queuedAt = std::chrono::steady_clock::now();
+        return std::atomic_load(&pool_)->submit(std::move(task), lane);
     }
 
 private:
-    void workerLoop(int idx)
-    {
-        while (!stop_)
-        {
-            EmailTask task;
-            {
-                std::unique_lock<std::mutex> lk(mtx_);
-                cv_.wait(lk, [&] {
-                    return stop_ || !tasks_.empty();
-                });
-                if (stop_)
-                    break;
-                task = tasks_.front();
-                tasks_.pop();
-            }
 
-            handleTask(task);
-        }
-    }
+    // 去重锁 + 写验证码合并为一次原子脚本调用：
+    // email_dedup:{email} 抢锁成功才写入验证码并返回 1，已在去重窗口内返回 0
+    // 去重锁的值是消息令牌（topic:partition:offset），用于识别重投：
+    // 返回 {1, code} 新抢到锁；{2, code} 同一条消息重投且尚未确认送达，沿用已写入的验证码重发；{0} 重复请求或已送达
+    static constexpr const char *kDedupAndStoreScript =
+        "local cur = redis.call('GET', KEYS[1]) "
+        "if not cur then "
+        "redis.call('SET', KEYS[1], ARGV[4], 'EX', ARGV[1]) "
+        "redis.call('SET', KEYS[2], ARGV[2], 'EX', ARGV[3]) return {1, ARGV[2]} end "
+        "if cur == ARGV[4] then "
+        "local code = redis.call('GET', KEYS[2]) "
+        "if not code then code = ARGV[2] redis.call('SET', KEYS[2], code, 'EX', ARGV[3]) end "
+        "return {2, code} end "
+        "return {0}";
+
+    // 送达后把令牌标记为 sent:，之后同一条消息再被投递也不会重发；保留原有过期时间
+    static constexpr const char *kMarkSentScript =
+        "if redis.call('GET', KEYS[1]) == ARGV[1] then "
+        "local ttl = redis.call('PTTL', KEYS[1]) "
+        "if ttl > 0 then redis.call('SET', KEYS[1], 'sent:' .. ARGV[1], 'PX', ttl) end end "
+        "return 0";
 
     void handleTask(const EmailTask &task)
     {
+        const AppConfig &cfg = AppConfig::getInstance();
+        auto &m = EmailMetrics::instance();
+        m.queueStage.observeMicros(elapsedMicros(task.queuedAt));
+        if (abandonQueued_.load(std::memory_order_acquire))
+        {
+            leaveForRedelivery(task, "shutdown drain deadline passed");
+            return;
+        }
         try
         {
             auto email = task.email;
-            // 1. 防重复：email_dedup:{email} 60秒内只能发一次
-            string dedupKey = "email_dedup:" + email;
 
-            redisContext *c = redisPool_.get();
-            redisReply *r = (redisReply *)redisCommand(
-                c, "SET %s 1 NX EX %d", dedupKey.c_str(), cfg_.email.dedup_ttl_sec);
-            bool canSend = false;
-            if (r)
+            // 截止时间 = 请求时间 + 验证码有效期；按近期平均发送耗时预估送达时剩余的有效期，
+            // 不够用就直接丢弃，不在用户已经用不上的验证码上花 SMTP 资源
+            int codeTtlSec = cfg.email.code_ttl_sec;
+            if (task.enqueueMs > 0)
             {
-                if (r->type == REDIS_REPLY_STATUS && string(r->str) == "OK")
-                    canSend = true; // SET 成功，说明之前没有锁
-                freeReplyObject(r);
-            }
-            else
-            {
-                std::cerr << "Redis SET NX failed for dedup key" << std::endl;
+                const int64_t nowMs = unixMillis();
+                const int64_t deadlineMs = task.enqueueMs + (int64_t)cfg.email.code_ttl_sec * 1000;
+                const int64_t expectedSendMs = sendEwmaUs_.load(std::memory_order_relaxed) / 1000;
+                if (deadlineMs - nowMs - expectedSendMs < (int64_t)cfg.email.min_remaining_sec * 1000)
+                {
+                    std::cout << "[EmailService] Drop expired task for " << email << ", queued "
+                              << (nowMs - task.enqueueMs) << "ms" << std::endl;
+                    m.expired.inc();
+                    // 重试中的任务已经占了去重锁，要释放掉，否则用户在去重窗口内无法重新获取
+                    if (!task.code.empty())
+                        giveUp(task, "expired before delivery", 0);
+                    return;
+                }
+                // 验证码只在原定截止时间之前有效
+                codeTtlSec = (int)std::max<int64_t>(1, (deadlineMs - nowMs) / 1000);
             }
 
-            if (!canSend)
+            // 重试：验证码已写入 Redis，直接重发同一个码
+            if (!task.code.empty())
             {
-                std::cout << "[EmailService] Skip duplicate email within dedup ttl: " << email << std::endl;
-                redisPool_.put(c);
+                sendCode(task, codeTtlSec, std::chrono::steady_clock::now());
                 return;
             }
 
-            // 2. 生成验证码，写入 redis：email_code:{email}
-            string code = gen_code();
+            string dedupKey = "email_dedup:" + email;
             string codeKey = email;
-            r = (redisReply *)redisCommand(
-                c, "SET %s %s EX %d", codeKey.c_str(), code.c_str(), cfg_.email.code_ttl_sec);
-            if (!r)
-            {
-               std::cerr << "Redis SET code failed" << std::endl;
-                redisPool_.put(c);
-                return;
-            }
-            freeReplyObject(r);
-            redisPool_.put(c);
-
-            // 3. 准备邮件内容（支持 text/plain 或 html）
-            string subject = "您的 CloudDisk 登录验证码";
-            // 简单 text 内容
-            string body = "您的验证码为: " + code + "\n有效期 "
-                          + std::to_string(cfg_.email.code_ttl_sec / 60) + " 分钟，请勿泄露。";
+            EmailTask next = task;
+            next.code = gen_code();
+            // 非 Kafka 来源的任务没有令牌，用随机值保证不会被误认成重投
+            if (next.token.empty())
+                next.token = "local:" + gen_code() + gen_code();
+            const auto startedAt = std::chrono::steady_clock::now();
 
-            bool ok = sender_.sendEmail(email, subject, body, false);
-            if (ok)
-            {
-                std::cout << "[EmailService] Sent code " << code << " to " << email << std::endl;
-            }
-            else
-            {
-                std::cerr << "[EmailService] Failed to send email to " << email << std::endl;
-            }
+            // 一次往返完成去重与写码；异步模式下 worker 提交后立即返回，回调在 Redis 事件循环中执行
+            redis()->commandAsync(
+                {"EVAL", kDedupAndStoreScript, "2", dedupKey, codeKey,
+                 std::to_string(cfg.email.dedup_ttl_sec), next.code, std::to_string(codeTtlSec), next.token},
+                [this, next = std::move(next), codeTtlSec, startedAt](redisReply *r) mutable
+                {
+                    auto &m = EmailMetrics::instance();
+                    m.redisStage.observeMicros(elapsedMicros(startedAt));
+                    if (!r || r->type == REDIS_REPLY_ERROR)
+                    {
+                        m.redisError.inc();
+                        std::cerr << "Redis dedup/store code failed for " << next.email << ": "
+                                  << (r && r->str ? r->str : "no reply") << std::endl;
+                        retryLater(next, "redis dedup/store failed");
+                        return;
+                    }
+                    long long verdict = r->type == REDIS_REPLY_ARRAY && r->elements > 0 ? r->element[0]->integer : 0;
+                    if (verdict == 0)
+                    {
+                        m.duplicate.inc();
+                        return;
+                    }
+                    if (verdict == 2)
+                    {
+                        // 停机 / 崩溃前没确认送达的消息被重投：沿用已存的验证码
+                        m.redelivered.inc();
+                        if (r->elements > 1 && r->element[1]->str)
+                            next.code.assign(r->element[1]->str, r->element[1]->len);
+                    }
+                    sendCode(next, codeTtlSec, startedAt);
+                });
         }
         catch (const std::exception &e)
         {
             std::cerr << "[EmailService] handleTask exception: " << e.what() << std::endl;
+            retryLater(task, "handleTask exception");
+        }
+    }
+
+    void sendCode(const EmailTask &task, int codeTtlSec, std::chrono::steady_clock::time_point startedAt)
+    {
+        // 用预编译模板一次性渲染整封报文
+        string ttlMin = std::to_string(std::max(1, codeTtlSec / 60));
+        string payload = templates_.get()->render(task.email, EmailVars{task.code, ttlMin, task.email});
+
+        // 异步发送：worker 不再阻塞在 SMTP 往返上
+        EmailMetrics::instance().smtpInFlight.add(1);
+        const auto smtpStart = std::chrono::steady_clock::now();
+        std::atomic_load(&sender_)->sendRawAsync(task.email, std::move(payload),
+                             [this, task, startedAt, smtpStart](const SmtpResult &result)
+                             {
+                                 auto &m = EmailMetrics::instance();
+                                 m.smtpInFlight.add(-1);
+                                 m.smtpStage.observeMicros(elapsedMicros(smtpStart));
+                                 observeSendLatency(elapsedMicros(startedAt));
+                                 if (result.aborted)
+                                 {
+                                     leaveForRedelivery(task, "smtp send aborted on shutdown");
+                                     return;
+                                 }
+                                 if (result.ok)
+                                 {
+                                     // 验证码只进邮件，不进日志
+                                     m.sent.inc();
+                                     markSent(task);
+                                     if (task.enqueueMs > 0)
+                                         m.endToEnd.observeMicros((unixMillis() - task.enqueueMs) * 1000);
+                                     return;
+                                 }
+                                 std::cerr << "[EmailService] Failed to send email to " << task.email << " (attempt "
+                                           << task.attempt + 1 << "): " << result.err << std::endl;
+                                 onSendFailed(task, result);
+                             });
+    }
+
+    // ====== 失败处理：暂时性错误按退避重试，其余进死信 ======
+    void onSendFailed(const EmailTask &task, const SmtpResult &result)
+    {
+        const int maxAttempts = retryMaxAttempts(AppConfig::getInstance().email);
+        if (!result.retryable || task.attempt + 1 >= maxAttempts)
+        {
+            giveUp(task, result.err, result.responseCode);
+            return;
+        }
+
+        EmailMetrics::instance().retried.inc();
+        EmailTask retry = task;
+        ++retry.attempt;
+        // 重试走低优先级通道，不挤占新请求的验证码
+        retry.priority = EmailPriority::kBulk;
+        int64_t delayMs = retryDelayMs(retry.attempt);
+        if (!scheduleRetry(std::move(retry), delayMs))
+            leaveForRedelivery(task);
+    }
+
+    // 去重 / 写码没有结果（Redis 出错、无应答或抛异常）：脚本可能已执行也可能没有，
+    // 清掉验证码、带着同一个令牌重新走去重，已写入的会按重投（verdict 2）沿用原验证码；
+    // 次数用完或排不进时间轮就不确认，留给重投，不能让回执把 offset 标记为完成
+    void retryLater(const EmailTask &task, const char *reason)
+    {
+        const int maxAttempts = retryMaxAttempts(AppConfig::getInstance().email);
+        EmailTask retry = task;
+        retry.code.clear();
+        ++retry.attempt;
+        retry.priority = EmailPriority::kBulk;
+        const int64_t delayMs = retryDelayMs(retry.attempt);
+        if (retry.attempt < maxAttempts && scheduleRetry(std::move(retry), delayMs))
+        {
+            EmailMetrics::instance().retried.inc();
+            return;
+        }
+        leaveForRedelivery(task, reason);
+    }
+
+    // 放弃的任务：不释放去重令牌、不进死信，其 offset 没有提交，重启后重投时凭令牌重发
+    void leaveForRedelivery(const EmailTask &task, const char *reason = "shutting down")
+    {
+        EmailMetrics::instance().abandoned.inc();
+        if (task.ack)
+            task.ack->abandon();
+        std::cout << "[EmailService] Leave email to " << task.email << " for redelivery: " << reason << std::endl;
+    }
+
+    void markSent(const EmailTask &task)
+    {
+        if (task.token.empty())
+            return;
+        redis()->commandAsync({"EVAL", kMarkSentScript, "1", "email_dedup:" + task.email, task.token},
+                                [](redisReply *) {});
+    }
+
+    bool scheduleRetry(EmailTask &&task, int64_t delayMs)
+    {
+        auto holder = std::make_shared<EmailTask>(std::move(task));
+        return retryWheel_.schedule(delayMs, [this, holder]
+                                    {
+            // 线程池满时稍后再试，不阻塞时间轮线程
+            EmailTask t = *holder;
+            if (!enqueue(std::move(t)) && !scheduleRetry(EmailTask(*holder), 100))
+                leaveForRedelivery(*holder); });
+    }
+
+    static int retryMaxAttempts(const EmailBizConfig &email)
+    {
+        return email.retry_max_attempts > 0 ? email.retry_max_attempts : 1;
+    }
+
+    // 带抖动的指数退避（equal jitter）：[d/2, d]，d = min(base * 2^(attempt-1), max)
+    int64_t retryDelayMs(int attempt) const
+    {
+        // 只取一次快照：判断和取值必须来自同一份配置
+        const EmailBizConfig &email = AppConfig::getInstance().email;
+        int64_t base = email.retry_base_ms > 0 ? email.retry_base_ms : 1000;
+        int64_t cap = email.retry_max_ms > 0 ? email.retry_max_ms : 30000;
+        int64_t d = base;
+        for (int i = 1; i < attempt && d < cap; ++i)
+            d *= 2;
+        d = std::min(d, cap);
+        static thread_local std::mt19937_64 rng(std::random_device{}());
+        std::uniform_int_distribution<int64_t> dist(d / 2, d);
+        return dist(rng);
+    }
+
+    // 永久失败：释放去重锁并删掉没送达的验证码，让用户可以立刻重新获取；原任务写入死信 topic
+    void giveUp(const EmailTask &task, const string &reason, long smtpCode)
+    {
+        std::cerr << "[EmailService] Give up email to " << task.email << " after " << task.attempt + 1
+                  << " attempt(s): " << reason << std::endl;
+        EmailMetrics::instance().failed.inc();
+
+        redis()->commandAsync({"DEL", "email_dedup:" + task.email, task.email},
+                                [email = task.email](redisReply *r)
+                                {
+                                    if (!r || r->type == REDIS_REPLY_ERROR)
+                                        std::cerr << "Redis release dedup key failed for " << email << std::endl;
+                                });
+
+        auto dlq = std::atomic_load(&dlq_);
+        if (dlq->enabled())
+        {
+            nlohmann::json j;
+            j["email"] = task.email;
+            j["attempts"] = task.attempt + 1;
+            j["error"] = reason;
+            j["smtp_code"] = smtpCode;
+            j["enqueue_ms"] = task.enqueueMs;
+            j["failed_ms"] = unixMillis();
+            dlq->publish(task.email, j.dump());
+        }
+    }
+
+    // 队列深度、连接池等按需取值的指标；析构时注销，避免渲染时访问已销毁的对象
+    void registerGauges()
+    {
+        auto &r = metrics::Registry::instance();
+        r.gaugeFn("email_pool_pending", "Tasks queued in the worker pool", "", [this]
+                  { return std::atomic_load(&pool_)->pending(); });
+        r.gaugeFn("email_retry_pending", "Failed sends waiting for their retry timer", "", [this]
+                  { return (int64_t)retryWheel_.size(); });
+        r.gaugeFn("email_send_ewma_us", "Moving average of Redis + SMTP time per email (us)", "", [this]
+                  { return sendEwmaUs_.load(std::memory_order_relaxed); });
+        r.gaugeFn("email_redis_pool_connections", "Sync Redis pool connections", "state=\"in_use\"", [this]
+                  { return (int64_t)redis()->stats().inUse; });
+        r.gaugeFn("email_redis_pool_connections", "Sync Redis pool connections", "state=\"idle\"", [this]
+                  { return (int64_t)redis()->stats().idle; });
+        r.gaugeFn("email_redis_pool_checkout_timeouts", "Sync Redis pool checkouts that timed out", "", [this]
+                  { return (int64_t)redis()->stats().timeouts; });
+        r.gaugeFn("email_redis_pool_wait_us_max", "Longest sync Redis pool checkout wait (us)", "", [this]
+                  { return (int64_t)redis()->stats().waitMicrosMax; });
+    }
+
+    void unregisterGauges()
+    {
+        auto &r = metrics::Registry::instance();
+        r.removeGaugeFn("email_pool_pending", "");
+        r.removeGaugeFn("email_retry_pending", "");
+        r.removeGaugeFn("email_send_ewma_us", "");
+        r.removeGaugeFn("email_redis_pool_connections", "state=\"in_use\"");
+        r.removeGaugeFn("email_redis_pool_connections", "state=\"idle\"");
+        r.removeGaugeFn("email_redis_pool_checkout_timeouts", "");
+        r.removeGaugeFn("email_redis_pool_wait_us_max", "");
+    }
+
+    // 发送耗时（Redis + SMTP）的指数滑动平均，α = 1/8；并发更新偶有丢失无妨
+    void observeSendLatency(int64_t us)
+    {
+        int64_t old = sendEwmaUs_.load(std::memory_order_relaxed);
+        sendEwmaUs_.store(old == 0 ? us : old + (us - old) / 8, std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<RedisPool> redis() const { return std::atomic_load(&redisPool_); }
+
+    std::shared_ptr<WorkStealingPool<EmailTask>> makePool(const AppConfig &cfg)
+    {
+        return makeRetirable<WorkStealingPool<EmailTask>>(
+            cfg.worker_threads > 0 ? cfg.worker_threads : 8,
+            cfg.queue_capacity > 0 ? cfg.queue_capacity : 1024,
+            [this](EmailTask &&task) { handleTask(task); },
+            (size_t)EmailPriority::kCount);
+    }
+
+    // ====== 配置热更新 ======
+    // 可替换组件的删除器：被 swapAndRetire 摘下的实例，最后一个持有者放手时只发信号，
+    // 析构留给发起替换的线程（析构可能阻塞，也可能 join 持有者自己所在的线程）；其余照常就地析构
+    struct RetireSignal
+    {
+        std::shared_ptr<std::promise<void>> released; // 非空表示已有线程在等
+
+        template <typename T>
+        void operator()(T *p) const
+        {
+            if (released)
+                released->set_value();
+            else
+                delete p;
+        }
+    };
+
+    template <typename T, typename... Args>
+    static std::shared_ptr<T> makeRetirable(Args &&...args)
+    {
+        return std::shared_ptr<T>(new T(std::forward<Args>(args)...), RetireSignal{});
+    }
+
+    // 新实例先建好再原子替换，调用方随即切过去；旧实例等仍在使用它的调用方放手后在本线程析构，
+    // 析构时把已提交的工作做完（线程池执行完队列、SMTP 发完在途邮件、Redis / 死信 冲刷）
+    template <typename T>
+    static void swapAndRetire(std::shared_ptr<T> &slot, std::shared_ptr<T> next)
+    {
+        auto old = std::atomic_exchange(&slot, std::move(next));
+        if (!old)
+            return;
+        // 仍持有引用时登记等待，之后的最后一次释放必然看到它
+        auto released = std::make_shared<std::promise<void>>();
+        std::future<void> done = released->get_future();
+        std::get_deleter<RetireSignal>(old)->released = std::move(released);
+        std::unique_ptr<T> owned(old.get());
+        old.reset();
+        done.wait();
+    }
+
+    static bool sameRedisEndpoint(const RedisConfig &a, const RedisConfig &b)
+    {
+        return std::tie(a.host, a.port, a.async, a.checkout_timeout_ms, a.connect_timeout_ms, a.command_timeout_ms,
+                        a.health_interval_ms, a.idle_timeout_ms) ==
+               std::tie(b.host, b.port, b.async, b.checkout_timeout_ms, b.connect_timeout_ms, b.command_timeout_ms,
+                        b.health_interval_ms, b.idle_timeout_ms);
+    }
+
+    static bool sameSmtp(const SmtpConfig &a, const SmtpConfig &b)
+    {
+        auto key = [](const SmtpConfig &c)
+        {
+            return std::tie(c.url, c.user, c.pass, c.from, c.from_name, c.transport_threads,
+                            c.max_concurrent_per_thread, c.relay_window_sec, c.relay_min_requests,
+                            c.relay_error_threshold_pct, c.relay_open_ms);
+        };
+        if (key(a) != key(b) || a.relays.size() != b.relays.size())
+            return false;
+        for (size_t i = 0; i < a.relays.size(); ++i)
+        {
+            const auto &x = a.relays[i], &y = b.relays[i];
+            if (std::tie(x.url, x.user, x.pass, x.weight, x.max_concurrent) !=
+                std::tie(y.url, y.user, y.pass, y.weight, y.max_concurrent))
+                return false;
+        }
+        return true;
+    }
+
+    void applyConfig(const AppConfig &prev, const AppConfig &next)
+    {
+        templates_.reload(next.smtp, next.email);
+
+        if (!sameRedisEndpoint(prev.redis, next.redis))
+        {
+            swapAndRetire(redisPool_, makeRetirable<RedisPool>(next.redis));
+            std::cout << "[EmailService] Redis reconnected to " << next.redis.host << ":" << next.redis.port << std::endl;
+        }
+        else if (prev.redis.pool_min != next.redis.pool_min || prev.redis.pool_max != next.redis.pool_max)
+        {
+            redis()->resize(next.redis.pool_min, next.redis.pool_max);
+        }
+
+        if (prev.kafka.brokers != next.kafka.brokers || prev.kafka.dlq_topic != next.kafka.dlq_topic)
+            swapAndRetire(dlq_, makeRetirable<DeadLetterProducer>(next.kafka.brokers, next.kafka.dlq_topic));
+
+        if (!sameSmtp(prev.smtp, next.smtp))
+        {
+            swapAndRetire(sender_, makeRetirable<EmailSender>(next.smtp));
+            std::cout << "[EmailService] SMTP transport rebuilt" << std::endl;
+        }
+
+        if (prev.worker_threads != next.worker_threads || prev.queue_capacity != next.queue_capacity)
+        {
+            swapAndRetire(pool_, makePool(next));
+            std::cout << "[EmailService] Worker pool resized to " << next.worker_threads << " thread(s)" << std::endl;
         }
     }
 
 private:
-    const AppConfig &cfg_;
-    RedisPool redisPool_;
-    EmailSender sender_;
-
-    std::vector< std::thread> workers_;
-    std::queue<EmailTask> tasks_;
-    std::mutex mtx_;
-    std::condition_variable cv_;
-    std::atomic<bool> stop_;
+    std::atomic<int64_t> sendEwmaUs_{0};
+    std::atomic<bool> abandonQueued_{false}; // 停机超过排空期限后置位，worker 不再执行取到的任务
+    int configSub_ = 0;
+    // 以下组件可被配置热更新整体替换，一律经 std::atomic_load / atomic_exchange 访问
+    std::shared_ptr<RedisPool> redisPool_;
+    std::shared_ptr<DeadLetterProducer> dlq_;
+    TimerWheel retryWheel_;
+    std::shared_ptr<EmailSender> sender_;
+    EmailTemplateStore templates_;
+
+    // 必须最后声明：worker 线程引用上面的成员
+    std::shared_ptr<WorkStealingPool<EmailTask>> pool_;
 };
 
 #endif // !EMAILSERVER_H
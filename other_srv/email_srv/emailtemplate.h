@@ -0,0 +1,296 @@
+#ifndef EMAILTEMPLATE_H
+#define EMAILTEMPLATE_H
+
+#include "config/config.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// ============ 邮件模板 ============
+// 模板文本里用 {{code}} / {{ttl_min}} / {{email}} 引用变量，未知占位符原样保留。
+// 启动时（及 Nacos 配置变更时）编译成「字面量 / 变量」片段列表；
+// 每封邮件先算出精确长度，一次 reserve 后顺序写入，整封报文只分配一次。
+
+// 渲染变量
+struct EmailVars
+{
+    std::string_view code;
+    std::string_view ttlMinutes;
+    std::string_view email;
+};
+
+class EmailTemplate
+{
+public:
+    EmailTemplate() = default;
+
+    // escapeHtml：HTML 部分中变量按 HTML 转义输出
+    EmailTemplate(std::string_view src, bool escapeHtml)
+        : escapeHtml_(escapeHtml)
+    {
+        size_t pos = 0;
+        string literal;
+        while (pos < src.size())
+        {
+            size_t open = src.find("{{", pos);
+            if (open == std::string_view::npos)
+            {
+                appendLiteral(literal, src.substr(pos));
+                break;
+            }
+            size_t close = src.find("}}", open + 2);
+            if (close == std::string_view::npos)
+            {
+                appendLiteral(literal, src.substr(pos));
+                break;
+            }
+            appendLiteral(literal, src.substr(pos, open - pos));
+
+            Var var = lookup(trim(src.substr(open + 2, close - open - 2)));
+            if (var == Var::kNone)
+            {
+                appendLiteral(literal, src.substr(open, close + 2 - open));
+            }
+            else
+            {
+                flush(literal);
+                segments_.push_back(Segment{var, string()});
+            }
+            pos = close + 2;
+        }
+        flush(literal);
+    }
+
+    bool empty() const { return segments_.empty(); }
+
+    size_t size(const EmailVars &vars) const
+    {
+        size_t n = 0;
+        for (const auto &s : segments_)
+            n += s.var == Var::kNone ? s.text.size() : valueSize(value(s.var, vars));
+        return n;
+    }
+
+    void renderTo(string &out, const EmailVars &vars) const
+    {
+        for (const auto &s : segments_)
+        {
+            if (s.var == Var::kNone)
+                out.append(s.text);
+            else
+                appendValue(out, value(s.var, vars));
+        }
+    }
+
+private:
+    enum class Var
+    {
+        kNone, // 字面量
+        kCode,
+        kTtlMinutes,
+        kEmail,
+    };
+
+    struct Segment
+    {
+        Var var;
+        string text;
+    };
+
+    static std::string_view trim(std::string_view s)
+    {
+        while (!s.empty() && s.front() == ' ')
+            s.remove_prefix(1);
+        while (!s.empty() && s.back() == ' ')
+            s.remove_suffix(1);
+        return s;
+    }
+
+    static Var lookup(std::string_view name)
+    {
+        if (name == "code")
+            return Var::kCode;
+        if (name == "ttl_min")
+            return Var::kTtlMinutes;
+        if (name == "email")
+            return Var::kEmail;
+        return Var::kNone;
+    }
+
+    static std::string_view value(Var var, const EmailVars &vars)
+    {
+        switch (var)
+        {
+        case Var::kCode:
+            return vars.code;
+        case Var::kTtlMinutes:
+            return vars.ttlMinutes;
+        case Var::kEmail:
+            return vars.email;
+        default:
+            return std::string_view();
+        }
+    }
+
+    // SMTP 报文要求 CRLF，编译时统一把裸 \n 换成 \r\n
+    static void appendLiteral(string &literal, std::string_view s)
+    {
+        for (size_t i = 0; i < s.size(); ++i)
+        {
+            if (s[i] == '\n' && (i == 0 ? (literal.empty() || literal.back() != '\r') : s[i - 1] != '\r'))
+                literal += '\r';
+            literal += s[i];
+        }
+    }
+
+    void flush(string &literal)
+    {
+        if (literal.empty())
+            return;
+        segments_.push_back(Segment{Var::kNone, std::move(literal)});
+        literal.clear();
+    }
+
+    static const char *escapeOf(char c)
+    {
+        switch (c)
+        {
+        case '&':
+            return "&amp;";
+        case '<':
+            return "&lt;";
+        case '>':
+            return "&gt;";
+        case '"':
+            return "&quot;";
+        default:
+            return nullptr;
+        }
+    }
+
+    size_t valueSize(std::string_view v) const
+    {
+        if (!escapeHtml_)
+            return v.size();
+        size_t n = 0;
+        for (char c : v)
+        {
+            const char *e = escapeOf(c);
+            n += e ? strlen(e) : 1;
+        }
+        return n;
+    }
+
+    void appendValue(string &out, std::string_view v) const
+    {
+        if (!escapeHtml_)
+        {
+            out.append(v.data(), v.size());
+            return;
+        }
+        for (char c : v)
+        {
+            if (const char *e = escapeOf(c))
+                out.append(e);
+            else
+                out += c;
+        }
+    }
+
+    std::vector<Segment> segments_;
+    bool escapeHtml_ = false;
+};
+
+// ============ 验证码邮件：整封 RFC 5322 报文 ============
+// 配了 HTML 模板时渲染 multipart/alternative（text + html），否则只有 text/plain。
+// 固定头部（From、MIME 头、分隔行）编译期拼好，渲染时只填变量。
+class CodeEmailRenderer
+{
+public:
+    CodeEmailRenderer(const SmtpConfig &smtp, const EmailBizConfig &email)
+        : subject_(email.subject_template, false),
+          text_(email.text_template, false),
+          html_(email.html_template, true)
+    {
+        fromHeader_ = "From: " + smtp.from_name + " <" + smtp.from + ">\r\nTo: <";
+        subjectHeader_ = ">\r\nSubject: ";
+        if (html_.empty())
+        {
+            bodyHeader_ = "\r\nMIME-Version: 1.0\r\n"
+                          "Content-Type: text/plain; charset=UTF-8\r\n"
+                          "Content-Transfer-Encoding: 8bit\r\n\r\n";
+            middle_.clear();
+            trailer_ = "\r\n";
+        }
+        else
+        {
+            const string boundary = "=_clouddisk_alt_boundary";
+            bodyHeader_ = "\r\nMIME-Version: 1.0\r\n"
+                          "Content-Type: multipart/alternative; boundary=\"" + boundary + "\"\r\n\r\n"
+                          "--" + boundary + "\r\n"
+                          "Content-Type: text/plain; charset=UTF-8\r\n"
+                          "Content-Transfer-Encoding: 8bit\r\n\r\n";
+            middle_ = "\r\n--" + boundary + "\r\n"
+                      "Content-Type: text/html; charset=UTF-8\r\n"
+                      "Content-Transfer-Encoding: 8bit\r\n\r\n";
+            trailer_ = "\r\n--" + boundary + "--\r\n";
+        }
+    }
+
+    string render(const string &to, const EmailVars &vars) const
+    {
+        size_t n = fromHeader_.size() + to.size() + subjectHeader_.size() + subject_.size(vars) +
+                   bodyHeader_.size() + text_.size(vars) + trailer_.size();
+        if (!html_.empty())
+            n += middle_.size() + html_.size(vars);
+
+        string out;
+        out.reserve(n);
+        out.append(fromHeader_);
+        out.append(to);
+        out.append(subjectHeader_);
+        subject_.renderTo(out, vars);
+        out.append(bodyHeader_);
+        text_.renderTo(out, vars);
+        if (!html_.empty())
+        {
+            out.append(middle_);
+            html_.renderTo(out, vars);
+        }
+        out.append(trailer_);
+        return out;
+    }
+
+private:
+    EmailTemplate subject_;
+    EmailTemplate text_;
+    EmailTemplate html_;
+    string fromHeader_;
+    string subjectHeader_;
+    string bodyHeader_;
+    string middle_;
+    string trailer_;
+};
+
+// 当前生效的渲染器；配置变更时整体替换，渲染中的邮件继续用旧的那份
+class EmailTemplateStore
+{
+public:
+    void reload(const SmtpConfig &smtp, const EmailBizConfig &email)
+    {
+        std::atomic_store(&current_, std::shared_ptr<const CodeEmailRenderer>(
+                                         std::make_shared<CodeEmailRenderer>(smtp, email)));
+    }
+
+    std::shared_ptr<const CodeEmailRenderer> get() const
+    {
+        return std::atomic_load(&current_);
+    }
+
+private:
+    std::shared_ptr<const CodeEmailRenderer> current_;
+};
+
+#endif // !EMAILTEMPLATE_H
@@ -1,5 +1,7 @@
 #include "KafkaConsumer.h"
+#include "metricsserver.h"
 #include <signal.h>
+#include <tuple>
 
 void signal_handler(int sig)
 {
@@ -19,12 +21,27 @@ int main(int argc, char *argv[])
 
 	try
 	{
+		MetricsServer metricsServer(AppConfig::getInstance().metrics_port);
 		EmailService emailSvc(AppConfig::getInstance());
-		KafkaConsumer consumer(AppConfig::getInstance().kafka, emailSvc);
 
-		std::cout << "Email service started. Listening Kafka topic: "
-				  << AppConfig::getInstance().kafka.topic << std::endl;
-		consumer.loop();
+		// kafka 段变化时排空当前 consumer，按新快照重建（换 broker / topic / group 不必重启进程）
+		while (g_running)
+		{
+			const AppConfig &snapshot = AppConfig::getInstance();
+			const KafkaConfig &kafka = snapshot.kafka;
+			KafkaConsumer consumer(kafka, emailSvc);
+			int sub = SubscribeConfig([&consumer](const AppConfig &prev, const AppConfig &next)
+									  {
+				const KafkaConfig &a = prev.kafka, &b = next.kafka;
+				if (std::tie(a.brokers, a.topic, a.group_id, a.batch_size, a.max_in_flight, a.commit_interval_ms) !=
+					std::tie(b.brokers, b.topic, b.group_id, b.batch_size, b.max_in_flight, b.commit_interval_ms))
+					consumer.requestRestart(); },
+									  &snapshot);
+
+			std::cout << "Email service started. Listening Kafka topic: " << kafka.topic << std::endl;
+			consumer.loop();
+			UnsubscribeConfig(sub);
+		}
 	}
 	catch (const std::exception &e)
 	{
@@ -0,0 +1,256 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "metricsformat.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::string;
+
+// ============ 进程内指标（Prometheus 文本格式） ============
+// 指标对象注册一次后地址不变，调用方缓存引用；记录路径只有 relaxed 原子操作，不加锁。
+// 注册和 /metrics 渲染走同一把锁，都不在热路径上。
+namespace metrics
+{
+    class Counter
+    {
+    public:
+        void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    class Gauge
+    {
+    public:
+        void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+        void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+        int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> value_{0};
+    };
+
+    // HDR 风格的对数-线性直方图，单位微秒：
+    // 每个 2 的幂区间再均分 4 个子桶，相对误差 ≤ 25%，覆盖 1us ~ 约 2^36us（19 小时），无需预设桶边界。
+    // 输出给 Prometheus 时按 2 的幂折叠成 le 边界（与子桶边界严格对齐，不损失计数正确性）。
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int kSubBits = 2;
+        static constexpr int kSub = 1 << kSubBits;
+        static constexpr int kMaxMsb = 36;
+        static constexpr int kBuckets = kSub + (kMaxMsb - kSubBits + 1) * kSub;
+
+        LatencyHistogram()
+        {
+            for (auto &b : buckets_)
+                b.store(0, std::memory_order_relaxed);
+        }
+
+        void observeMicros(int64_t us)
+        {
+            uint64_t v = us > 0 ? (uint64_t)us : 0;
+            buckets_[indexOf(v)].fetch_add(1, std::memory_order_relaxed);
+            sumMicros_.fetch_add(v, std::memory_order_relaxed);
+        }
+
+        // 桶的下界（含）
+        static uint64_t lowerBound(int idx)
+        {
+            if (idx < kSub)
+                return (uint64_t)idx;
+            int msb = (idx - kSub) / kSub + kSubBits;
+            int sub = (idx - kSub) % kSub;
+            return (uint64_t)(kSub + sub) << (msb - kSubBits);
+        }
+
+        static int indexOf(uint64_t v)
+        {
+            if (v < (uint64_t)kSub)
+                return (int)v;
+            int msb = 63 - __builtin_clzll(v);
+            if (msb > kMaxMsb)
+                return kBuckets - 1;
+            int sub = (int)((v >> (msb - kSubBits)) & (kSub - 1));
+            return kSub + (msb - kSubBits) * kSub + sub;
+        }
+
+        std::vector<uint64_t> snapshot() const
+        {
+            std::vector<uint64_t> out(kBuckets);
+            for (int i = 0; i < kBuckets; ++i)
+                out[i] = buckets_[i].load(std::memory_order_relaxed);
+            return out;
+        }
+
+        uint64_t sumMicros() const { return sumMicros_.load(std::memory_order_relaxed); }
+
+        // 近似分位数（微秒，取所在桶下界），q ∈ [0, 1]
+        uint64_t quantileMicros(double q) const
+        {
+            auto s = snapshot();
+            uint64_t total = 0;
+            for (auto c : s)
+                total += c;
+            if (total == 0)
+                return 0;
+            uint64_t rank = (uint64_t)(q * (double)(total - 1)) + 1;
+            uint64_t seen = 0;
+            for (int i = 0; i < kBuckets; ++i)
+            {
+                seen += s[i];
+                if (seen >= rank)
+                    return lowerBound(i);
+            }
+            return lowerBound(kBuckets - 1);
+        }
+
+    private:
+        std::atomic<uint64_t> buckets_[kBuckets];
+        std::atomic<uint64_t> sumMicros_{0};
+    };
+
+    class Registry
+    {
+    public:
+        using GaugeFn = std::function<int64_t()>;
+
+        static Registry &instance()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        // labels 形如 stage="smtp",result="ok"；同名同标签重复注册返回同一个对象
+        Counter &counter(const string &name, const string &help, const string &labels = "")
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            auto &slot = family(name, Type::kCounter, help).counters[labels];
+            if (!slot)
+                slot.reset(new Counter());
+            return *slot;
+        }
+
+        Gauge &gauge(const string &name, const string &help, const string &labels = "")
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            auto &slot = family(name, Type::kGauge, help).gauges[labels];
+            if (!slot)
+                slot.reset(new Gauge());
+            return *slot;
+        }
+
+        // 渲染时才取值的 gauge（队列深度、连接池占用等），同名同标签再次注册会替换取值函数
+        void gaugeFn(const string &name, const string &help, const string &labels, GaugeFn fn)
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            family(name, Type::kGauge, help).gaugeFns[labels] = std::move(fn);
+        }
+
+        void removeGaugeFn(const string &name, const string &labels)
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            auto it = families_.find(name);
+            if (it != families_.end())
+                it->second.gaugeFns.erase(labels);
+        }
+
+        LatencyHistogram &histogram(const string &name, const string &help, const string &labels = "")
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            auto &slot = family(name, Type::kHistogram, help).histograms[labels];
+            if (!slot)
+                slot.reset(new LatencyHistogram());
+            return *slot;
+        }
+
+        string render()
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            string out;
+            out.reserve(families_.size() * 512);
+            for (const auto &kv : families_)
+            {
+                const string &name = kv.first;
+                const Family &fam = kv.second;
+                const char *type = fam.type == Type::kCounter ? "counter" : fam.type == Type::kGauge ? "gauge"
+                                                                                                      : "histogram";
+                text::appendHeader(out, name, fam.help, type);
+                for (const auto &c : fam.counters)
+                    text::appendSample(out, name, c.first, std::to_string(c.second->value()));
+                for (const auto &g : fam.gauges)
+                    text::appendSample(out, name, g.first, std::to_string(g.second->value()));
+                for (const auto &g : fam.gaugeFns)
+                    text::appendSample(out, name, g.first, std::to_string(g.second ? g.second() : 0));
+                for (const auto &h : fam.histograms)
+                    renderHistogram(out, name, h.first, *h.second);
+            }
+            return out;
+        }
+
+    private:
+        enum class Type
+        {
+            kCounter,
+            kGauge,
+            kHistogram,
+        };
+
+        struct Family
+        {
+            Type type;
+            string help;
+            std::map<string, std::unique_ptr<Counter>> counters;
+            std::map<string, std::unique_ptr<Gauge>> gauges;
+            std::map<string, GaugeFn> gaugeFns;
+            std::map<string, std::unique_ptr<LatencyHistogram>> histograms;
+        };
+
+        Family &family(const string &name, Type type, const string &help)
+        {
+            auto it = families_.find(name);
+            if (it == families_.end())
+                it = families_.emplace(name, Family{type, help, {}, {}, {}, {}}).first;
+            return it->second;
+        }
+
+        // le 取 2 的幂微秒边界（128us 起，到 60 秒为止），子桶按所在区间累加
+        static void renderHistogram(string &out, const string &name, const string &labels, const LatencyHistogram &h)
+        {
+            constexpr int kFirstMsb = 7; // 128us
+            auto s = h.snapshot();
+            std::vector<double> bounds;
+            std::vector<uint64_t> cumulatives;
+            uint64_t cumulative = 0;
+            int idx = 0;
+            for (int msb = kFirstMsb; msb <= LatencyHistogram::kMaxMsb; ++msb)
+            {
+                const uint64_t bound = 1ull << msb; // 该 le 包含所有 < bound 的桶
+                while (idx < LatencyHistogram::kBuckets && LatencyHistogram::lowerBound(idx) < bound)
+                    cumulative += s[idx++];
+                // 超过 60 秒的区间不再单独输出
+                if (bound > 60ull * 1000 * 1000)
+                    break;
+                bounds.push_back(bound / 1e6);
+                cumulatives.push_back(cumulative);
+            }
+            while (idx < LatencyHistogram::kBuckets)
+                cumulative += s[idx++];
+            text::appendHistogram(out, name, labels, bounds, cumulatives, cumulative, h.sumMicros() / 1e6);
+        }
+
+        std::mutex mtx_;
+        std::map<string, Family> families_;
+    };
+}
+
+#endif // !METRICS_H
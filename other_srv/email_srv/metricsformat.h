@@ -0,0 +1,65 @@
+#ifndef METRICSFORMAT_H
+#define METRICSFORMAT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// ============ Prometheus 文本格式的拼装 ============
+// email_srv（metrics.h）和网关（Metrics.cc）的 /metrics 共用，两边只负责取数，输出格式只在这里维护
+namespace metrics
+{
+    namespace text
+    {
+        // labels 形如 stage="smtp"，extra 追加在后面（如 le="0.5"），都为空时不输出花括号
+        inline std::string withLabels(const std::string &labels, const std::string &extra = "")
+        {
+            if (labels.empty() && extra.empty())
+                return std::string();
+            if (labels.empty())
+                return "{" + extra + "}";
+            if (extra.empty())
+                return "{" + labels + "}";
+            return "{" + labels + "," + extra + "}";
+        }
+
+        // 最短的能原样读回的表示：%g 只有 6 位有效数字，累计的 _sum 会被截断
+        inline std::string formatDouble(double v)
+        {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.15g", v);
+            if (std::strtod(buf, nullptr) != v)
+                std::snprintf(buf, sizeof(buf), "%.17g", v);
+            return buf;
+        }
+
+        // type 为 counter / gauge / histogram
+        inline void appendHeader(std::string &out, const std::string &name, const std::string &help, const char *type)
+        {
+            out += "# HELP " + name + " " + help + "\n";
+            out += "# TYPE " + name + " " + type + "\n";
+        }
+
+        inline void appendSample(std::string &out, const std::string &name, const std::string &labels, const std::string &value)
+        {
+            out += name + withLabels(labels) + " " + value + "\n";
+        }
+
+        // bounds 为各 le 上界（秒，升序），cumulative[i] 为 ≤ bounds[i] 的累计计数；count 含 +Inf 桶
+        inline void appendHistogram(std::string &out, const std::string &name, const std::string &labels,
+                                    const std::vector<double> &bounds, const std::vector<uint64_t> &cumulative,
+                                    uint64_t count, double sum)
+        {
+            for (size_t i = 0; i < bounds.size() && i < cumulative.size(); ++i)
+                out += name + "_bucket" + withLabels(labels, "le=\"" + formatDouble(bounds[i]) + "\"") + " " +
+                       std::to_string(cumulative[i]) + "\n";
+            out += name + "_bucket" + withLabels(labels, "le=\"+Inf\"") + " " + std::to_string(count) + "\n";
+            out += name + "_sum" + withLabels(labels) + " " + formatDouble(sum) + "\n";
+            out += name + "_count" + withLabels(labels) + " " + std::to_string(count) + "\n";
+        }
+    }
+}
+
+#endif // !METRICSFORMAT_H
@@ -0,0 +1,125 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include "metrics.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// ============ 极简 HTTP 指标端点 ============
+// 只服务 GET /metrics，单线程顺序处理（抓取频率很低），不引入 HTTP 库。
+class MetricsServer
+{
+public:
+    explicit MetricsServer(int port)
+    {
+        if (port <= 0)
+            return;
+        fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+        {
+            std::cerr << "[Metrics] socket failed: " << strerror(errno) << std::endl;
+            return;
+        }
+        int on = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t)port);
+        if (bind(fd_, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd_, 16) < 0)
+        {
+            std::cerr << "[Metrics] listen on :" << port << " failed: " << strerror(errno) << std::endl;
+            close(fd_);
+            fd_ = -1;
+            return;
+        }
+        running_.store(true);
+        thread_ = std::thread(&MetricsServer::loop, this);
+        std::cout << "[Metrics] serving /metrics on :" << port << std::endl;
+    }
+
+    ~MetricsServer()
+    {
+        running_.store(false);
+        if (thread_.joinable())
+            thread_.join();
+        if (fd_ >= 0)
+            close(fd_);
+    }
+
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+private:
+    void loop()
+    {
+        while (running_.load())
+        {
+            pollfd pfd{fd_, POLLIN, 0};
+            if (poll(&pfd, 1, 500) <= 0)
+                continue;
+            int conn = accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (conn < 0)
+                continue;
+            handle(conn);
+            close(conn);
+        }
+    }
+
+    void handle(int conn)
+    {
+        // 抓取方异常时不要卡住线程
+        timeval tv{2, 0};
+        setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        char buf[1024];
+        ssize_t n = recv(conn, buf, sizeof(buf) - 1, 0);
+        if (n <= 0)
+            return;
+        buf[n] = '\0';
+
+        string body;
+        const char *status;
+        if (strncmp(buf, "GET /metrics", 12) == 0 && (buf[12] == ' ' || buf[12] == '?'))
+        {
+            body = metrics::Registry::instance().render();
+            status = "200 OK";
+        }
+        else
+        {
+            body = "not found\n";
+            status = "404 Not Found";
+        }
+
+        string resp;
+        resp.reserve(128 + body.size());
+        resp.append("HTTP/1.1 ").append(status).append("\r\n");
+        resp.append("Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n");
+        resp.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+        resp.append("Connection: close\r\n\r\n");
+        resp.append(body);
+
+        size_t off = 0;
+        while (off < resp.size())
+        {
+            ssize_t w = send(conn, resp.data() + off, resp.size() - off, MSG_NOSIGNAL);
+            if (w <= 0)
+                break;
+            off += (size_t)w;
+        }
+    }
+
+    int fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+#endif // !METRICSSERVER_H
@@ -0,0 +1,106 @@
+#ifndef OFFSETTRACKER_H
+#define OFFSETTRACKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// ============ 分区 offset 跟踪：只提交连续完成的前缀 ============
+// 消费线程在派发前 begin()，任务完成（任意线程）时 complete()。
+// 每个分区可提交的 offset = 最小的未完成 offset；全部完成时为已派发的最大 offset + 1。
+// 这样即使任务乱序完成，提交点也不会越过仍在处理中的消息，崩溃后从未完成处重新消费（at-least-once）。
+class OffsetTracker
+{
+public:
+    struct Commit
+    {
+        int32_t partition;
+        int64_t offset;
+    };
+
+    // 分区重新分配时调用；旧一代任务的 complete() 会被忽略
+    uint64_t reset()
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        partitions_.clear();
+        inFlight_.store(0, std::memory_order_relaxed);
+        return ++generation_;
+    }
+
+    uint64_t generation() const
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return generation_;
+    }
+
+    void begin(int32_t partition, int64_t offset)
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        Partition &p = partitions_[partition];
+        p.pending.insert(offset);
+        if (offset + 1 > p.next)
+            p.next = offset + 1;
+        inFlight_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void complete(uint64_t generation, int32_t partition, int64_t offset)
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (generation != generation_)
+            return;
+        auto it = partitions_.find(partition);
+        if (it == partitions_.end())
+            return;
+        if (it->second.pending.erase(offset))
+            inFlight_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 停机时放弃的任务：offset 仍留在未完成集合里（提交点停在它之前，重启后重投），只是不再计入在途数
+    void abandon(uint64_t generation, int32_t partition, int64_t offset)
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (generation != generation_)
+            return;
+        auto it = partitions_.find(partition);
+        if (it != partitions_.end() && it->second.pending.count(offset))
+            inFlight_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 取出自上次以来前进过的提交点
+    std::vector<Commit> collect()
+    {
+        std::vector<Commit> out;
+        std::lock_guard<std::mutex> lk(mtx_);
+        for (auto &[partition, p] : partitions_)
+        {
+            int64_t commitable = p.pending.empty() ? p.next : *p.pending.begin();
+            if (commitable > p.committed)
+            {
+                out.push_back({partition, commitable});
+                p.committed = commitable;
+            }
+        }
+        return out;
+    }
+
+    // 派发后尚未完成的任务数
+    int64_t inFlight() const { return inFlight_.load(std::memory_order_relaxed); }
+
+private:
+    struct Partition
+    {
+        std::set<int64_t> pending;
+        int64_t next = -1;      // 已派发的最大 offset + 1
+        int64_t committed = -1; // 上次提交的 offset
+    };
+
+    mutable std::mutex mtx_;
+    uint64_t generation_ = 0;
+    std::map<int32_t, Partition> partitions_;
+    std::atomic<int64_t> inFlight_{0};
+};
+
+#endif // !OFFSETTRACKER_H
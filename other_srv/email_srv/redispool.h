@@ -3,77 +3,723 @@
 
 #include "config/config.h"
 #include <hiredis/hiredis.h>
+#include <hiredis/async.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-class RedisPool
+// reply 只在回调期间有效；连接失败、断线或退出时为 nullptr
+using RedisReplyCallback = std::function<void(redisReply *reply)>;
+
+// ============ hiredis 异步连接 + 专用 epoll 事件循环 ============
+// 一个线程、一条连接：其它线程提交的命令经 eventfd 唤醒后由循环线程写出，
+// 同一连接上的命令天然流水线化，调用方不阻塞、不占用连接。
+// 断线后所有未完成命令以 nullptr 回调，之后按退避间隔自动重连。
+class RedisAsyncLoop
 {
 public:
-    RedisPool(const RedisConfig &cfg, size_t poolSize)
+    explicit RedisAsyncLoop(const RedisConfig &cfg)
         : cfg_(cfg)
     {
-        for (size_t i = 0; i < poolSize; ++i)
+        epfd_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epfd_ < 0 || wakeFd_ < 0)
+            throw std::runtime_error("Redis async loop init failed");
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr; // nullptr 表示唤醒事件
+        epoll_ctl(epfd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+        thread_ = std::thread(&RedisAsyncLoop::run, this);
+    }
+
+    ~RedisAsyncLoop()
+    {
+        stop_.store(true);
+        wakeup();
+        if (thread_.joinable())
+            thread_.join();
+        close(wakeFd_);
+        close(epfd_);
+    }
+
+    RedisAsyncLoop(const RedisAsyncLoop &) = delete;
+    RedisAsyncLoop &operator=(const RedisAsyncLoop &) = delete;
+
+    // 线程安全；回调在循环线程中执行，不应在其中阻塞
+    void command(std::vector<string> argv, RedisReplyCallback cb)
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            inbox_.push_back(Pending{std::move(argv), std::move(cb)});
+        }
+        wakeup();
+    }
+
+private:
+    struct Pending
+    {
+        std::vector<string> argv;
+        RedisReplyCallback cb;
+    };
+
+    // ---- hiredis 事件适配：把读写关注点映射到 epoll ----
+    static void evAddRead(void *p) { static_cast<RedisAsyncLoop *>(p)->updateEvents(EPOLLIN, 0); }
+    static void evDelRead(void *p) { static_cast<RedisAsyncLoop *>(p)->updateEvents(0, EPOLLIN); }
+    static void evAddWrite(void *p) { static_cast<RedisAsyncLoop *>(p)->updateEvents(EPOLLOUT, 0); }
+    static void evDelWrite(void *p) { static_cast<RedisAsyncLoop *>(p)->updateEvents(0, EPOLLOUT); }
+    static void evCleanup(void *p) { static_cast<RedisAsyncLoop *>(p)->updateEvents(0, EPOLLIN | EPOLLOUT); }
+
+    void updateEvents(uint32_t add, uint32_t del)
+    {
+        if (!ac_)
+            return;
+        uint32_t next = (events_ | add) & ~del;
+        if (next == events_)
+            return;
+        epoll_event ev{};
+        ev.events = next;
+        ev.data.ptr = this;
+        int fd = ac_->c.fd;
+        if (events_ == 0)
+            epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev);
+        else if (next == 0)
+            epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+        else
+            epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev);
+        events_ = next;
+    }
+
+    static void onConnect(const redisAsyncContext *ac, int status)
+    {
+        auto *self = static_cast<RedisAsyncLoop *>(ac->data);
+        if (self->ac_ != ac)
+            return;
+        if (status != REDIS_OK)
+        {
+            // hiredis 随后会释放 ac
+            std::cerr << "Redis async connect error: " << (ac->errstr ? ac->errstr : "unknown") << std::endl;
+            self->detach();
+            return;
+        }
+        self->backoffMs_ = 0;
+        std::cout << "[Redis] async connection established" << std::endl;
+    }
+
+    static void onDisconnect(const redisAsyncContext *ac, int status)
+    {
+        auto *self = static_cast<RedisAsyncLoop *>(ac->data);
+        if (self->ac_ != ac)
+            return;
+        if (status != REDIS_OK && !self->stop_.load())
+            std::cerr << "Redis async disconnected: " << (ac->errstr ? ac->errstr : "unknown") << std::endl;
+        self->detach();
+    }
+
+    static void onReply(redisAsyncContext *, void *reply, void *privdata)
+    {
+        std::unique_ptr<RedisReplyCallback> cb(static_cast<RedisReplyCallback *>(privdata));
+        if (*cb)
+            (*cb)(static_cast<redisReply *>(reply));
+    }
+
+    // 连接已经（或即将）被 hiredis 释放，只清理本地状态并安排重连
+    void detach()
+    {
+        if (ac_ && events_ != 0)
+            epoll_ctl(epfd_, EPOLL_CTL_DEL, ac_->c.fd, nullptr);
+        ac_ = nullptr;
+        events_ = 0;
+        backoffMs_ = backoffMs_ == 0 ? 100 : std::min(backoffMs_ * 2, 5000);
+        reconnectAt_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoffMs_);
+    }
+
+    void connect()
+    {
+        redisAsyncContext *ac = redisAsyncConnect(cfg_.host.c_str(), cfg_.port);
+        if (!ac || ac->err)
+        {
+            std::cerr << "Redis async connect error: " << (ac ? ac->errstr : "allocation failed") << std::endl;
+            if (ac)
+                redisAsyncFree(ac);
+            ac_ = nullptr;
+            detach();
+            return;
+        }
+        ac_ = ac;
+        events_ = 0;
+        ac->data = this;
+        ac->ev.data = this;
+        ac->ev.addRead = evAddRead;
+        ac->ev.delRead = evDelRead;
+        ac->ev.addWrite = evAddWrite;
+        ac->ev.delWrite = evDelWrite;
+        ac->ev.cleanup = evCleanup;
+        redisAsyncSetConnectCallback(ac, onConnect);
+        redisAsyncSetDisconnectCallback(ac, onDisconnect);
+        // 非阻塞 connect 完成时 fd 可写
+        updateEvents(EPOLLOUT, 0);
+    }
+
+    void wakeup()
+    {
+        uint64_t one = 1;
+        ssize_t n = write(wakeFd_, &one, sizeof(one));
+        (void)n;
+    }
+
+    void drainInbox()
+    {
+        uint64_t cnt;
+        while (read(wakeFd_, &cnt, sizeof(cnt)) > 0)
+        {
+        }
+
+        std::deque<Pending> batch;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            batch.swap(inbox_);
+        }
+        std::vector<const char *> argv;
+        std::vector<size_t> argvlen;
+        for (auto &p : batch)
         {
-            redisContext *c = redisConnect(cfg_.host.c_str(), cfg_.port);
-            if (!c || c->err)
+            if (!ac_)
             {
-                if (c)
-                {
-                    std::cerr << "Redis connect error: " << c->errstr << std::endl;
-                    redisFree(c);
-                }
-                else
+                if (p.cb)
+                    p.cb(nullptr);
+                continue;
+            }
+            argv.clear();
+            argvlen.clear();
+            for (const auto &a : p.argv)
+            {
+                argv.push_back(a.data());
+                argvlen.push_back(a.size());
+            }
+            auto *cb = new RedisReplyCallback(std::move(p.cb));
+            if (redisAsyncCommandArgv(ac_, onReply, cb, (int)argv.size(), argv.data(), argvlen.data()) != REDIS_OK)
+            {
+                std::unique_ptr<RedisReplyCallback> owned(cb);
+                if (*owned)
+                    (*owned)(nullptr);
+            }
+        }
+    }
+
+    void run()
+    {
+        connect();
+        bool closing = false;
+        auto closeDeadline = std::chrono::steady_clock::time_point::max();
+        epoll_event events[16];
+        for (;;)
+        {
+            if (stop_.load() && !closing)
+            {
+                // 先把已提交的命令写出去，再优雅断开（等待已发出命令的回复）
+                drainInbox();
+                closing = true;
+                closeDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+                if (ac_)
+                    redisAsyncDisconnect(ac_);
+            }
+            if (closing && (!ac_ || std::chrono::steady_clock::now() >= closeDeadline))
+                break;
+
+            if (!ac_ && !closing && std::chrono::steady_clock::now() >= reconnectAt_)
+                connect();
+
+            int timeoutMs = ac_ ? 1000 : 100;
+            int n = epoll_wait(epfd_, events, 16, timeoutMs);
+            for (int i = 0; i < n; ++i)
+            {
+                if (events[i].data.ptr == nullptr)
                 {
-                    std::cerr << "Redis connect allocation error" << std::endl;
+                    drainInbox();
+                    continue;
                 }
-                throw std::runtime_error("Redis connect failed");
+                // 读回调可能触发断线并释放连接，每步前都要重新检查 ac_
+                uint32_t e = events[i].events;
+                if (ac_ && (e & (EPOLLIN | EPOLLERR | EPOLLHUP)))
+                    redisAsyncHandleRead(ac_);
+                if (ac_ && (e & (EPOLLOUT | EPOLLERR)))
+                    redisAsyncHandleWrite(ac_);
+            }
+        }
+
+        if (ac_)
+        {
+            // 超时仍未断开：强制释放，未完成命令以 nullptr 回调
+            redisAsyncContext *ac = ac_;
+            redisAsyncFree(ac);
+            ac_ = nullptr;
+        }
+        // 退出后提交的命令直接失败
+        std::deque<Pending> rest;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            rest.swap(inbox_);
+        }
+        for (auto &p : rest)
+        {
+            if (p.cb)
+                p.cb(nullptr);
+        }
+    }
+
+    RedisConfig cfg_;
+    int epfd_ = -1;
+    int wakeFd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::mutex mtx_;
+    std::deque<Pending> inbox_;
+
+    // 以下只在循环线程中访问
+    redisAsyncContext *ac_ = nullptr;
+    uint32_t events_ = 0;
+    int backoffMs_ = 0;
+    std::chrono::steady_clock::time_point reconnectAt_{};
+};
+
+// ============ 同步连接池 ============
+// - 连接数在 [pool_min, pool_max] 之间按需伸缩，空闲超过 idle_timeout_ms 的多余连接由后台线程回收
+// - 借用带超时，超时返回空 Lease，调用方自行降级，不会无限阻塞
+// - 后台线程定期 PING 空闲连接，坏连接直接丢弃；建连在锁外进行，失败后指数退避，
+//   期间借用方只等待已有连接，不会让每个 worker 都去撞一次不可达的 Redis
+// - 坏连接只减少计数，不会永久占掉一个槽位
+class RedisPool
+{
+public:
+    struct Stats
+    {
+        int total = 0;             // 当前连接数（含建连中）
+        int idle = 0;              // 空闲连接数
+        int inUse = 0;             // 已借出连接数
+        int max = 0;               // 上限
+        uint64_t checkouts = 0;    // 借用成功次数
+        uint64_t timeouts = 0;     // 借用超时次数
+        uint64_t connectFailures = 0;
+        uint64_t dropped = 0;      // 因出错 / 健康检查失败丢弃的连接数
+        uint64_t waitMicrosTotal = 0;
+        uint64_t waitMicrosMax = 0;
+        double utilisation() const { return max > 0 ? (double)inUse / max : 0.0; }
+    };
+
+    // RAII 借用：析构时归还；用过程中出错的连接归还时会被丢弃
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(RedisPool *pool, redisContext *c) : pool_(pool), c_(c) {}
+        ~Lease() { release(); }
+        Lease(Lease &&o) noexcept : pool_(o.pool_), c_(o.c_)
+        {
+            o.pool_ = nullptr;
+            o.c_ = nullptr;
+        }
+        Lease &operator=(Lease &&o) noexcept
+        {
+            if (this != &o)
+            {
+                release();
+                pool_ = o.pool_;
+                c_ = o.c_;
+                o.pool_ = nullptr;
+                o.c_ = nullptr;
             }
-            pool_.push_back(c);
+            return *this;
+        }
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+
+        explicit operator bool() const { return c_ != nullptr; }
+        redisContext *get() const { return c_; }
+        redisContext *operator->() const { return c_; }
+
+        void release()
+        {
+            if (pool_ && c_)
+                pool_->giveBack(c_);
+            pool_ = nullptr;
+            c_ = nullptr;
         }
+
+    private:
+        RedisPool *pool_ = nullptr;
+        redisContext *c_ = nullptr;
+    };
+
+    explicit RedisPool(const RedisConfig &cfg)
+        : cfg_(cfg)
+    {
+        maxSize_ = cfg_.pool_max > 0 ? cfg_.pool_max : 8;
+        minSize_ = std::min(std::max(cfg_.pool_min, 0), maxSize_);
+
+        // 启动时尽量建好 min 条；连不上不抛异常，由后台线程按退避继续补齐
+        for (int i = 0; i < minSize_; ++i)
+        {
+            redisContext *c = connectOne();
+            if (!c)
+                break;
+            std::lock_guard<std::mutex> lk(mtx_);
+            ++total_;
+            idle_.push_back(Idle{c, std::chrono::steady_clock::now()});
+        }
+        maintainer_ = std::thread(&RedisPool::maintainLoop, this);
+
+        if (cfg_.async)
+            async_.reset(new RedisAsyncLoop(cfg_));
     }
 
     ~RedisPool()
     {
-        for (auto c : pool_)
+        stopAsync();
         {
-            redisFree(c);
+            std::lock_guard<std::mutex> lk(mtx_);
+            stop_ = true;
         }
+        cv_.notify_all();
+        maintainCv_.notify_all();
+        if (maintainer_.joinable())
+            maintainer_.join();
+        for (auto &i : idle_)
+            redisFree(i.c);
     }
 
-    redisContext *get()
+    RedisPool(const RedisPool &) = delete;
+    RedisPool &operator=(const RedisPool &) = delete;
+
+    // 配置热更新只改了 min / max 时原地调整：多出的空闲连接立即关闭，借出的在归还时关闭，
+    // 不足 min 的由后台线程补齐
+    void resize(int minSize, int maxSize)
     {
+        std::vector<redisContext *> closing;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            maxSize_ = maxSize > 0 ? maxSize : 8;
+            minSize_ = std::min(std::max(minSize, 0), maxSize_);
+            minSize = minSize_;
+            maxSize = maxSize_;
+            while (total_ > maxSize_ && !idle_.empty())
+            {
+                closing.push_back(idle_.back().c);
+                idle_.pop_back();
+                --total_;
+            }
+        }
+        for (redisContext *c : closing)
+            redisFree(c);
+        cv_.notify_all();
+        maintainCv_.notify_one();
+        std::cout << "[Redis] pool resized to min=" << minSize << " max=" << maxSize << std::endl;
+    }
+
+    // 借一条连接，最多等 timeoutMs（< 0 时用配置的 checkout_timeout_ms）；超时 / 退避中返回空 Lease
+    Lease acquire(int timeoutMs = -1)
+    {
+        if (timeoutMs < 0)
+            timeoutMs = cfg_.checkout_timeout_ms;
+        const auto begin = std::chrono::steady_clock::now();
+        const auto deadline = begin + std::chrono::milliseconds(timeoutMs);
+
         std::unique_lock<std::mutex> lk(mtx_);
-        while (pool_.empty())
+        for (;;)
         {
-            cv_.wait(lk);
+            if (stop_)
+                return Lease();
+            if (!idle_.empty())
+            {
+                redisContext *c = idle_.back().c;
+                idle_.pop_back();
+                recordCheckout(begin);
+                return Lease(this, c);
+            }
+
+            // 没有空闲连接：未到上限且不在退避期就自己建一条（锁外建连）
+            auto now = std::chrono::steady_clock::now();
+            if (total_ < maxSize_ && now >= nextConnectAt_)
+            {
+                ++total_;
+                lk.unlock();
+                redisContext *c = connectOne();
+                lk.lock();
+                if (c)
+                {
+                    recordCheckout(begin);
+                    return Lease(this, c);
+                }
+                --total_;
+                cv_.notify_one();
+                continue;
+            }
+
+            auto wakeAt = deadline;
+            if (total_ < maxSize_ && nextConnectAt_ < wakeAt)
+                wakeAt = nextConnectAt_;
+            if (now >= deadline ||
+                (cv_.wait_until(lk, wakeAt) == std::cv_status::timeout && std::chrono::steady_clock::now() >= deadline))
+            {
+                // 最后再看一眼，避免与归还擦肩而过
+                if (!idle_.empty())
+                    continue;
+                ++timeouts_;
+                return Lease();
+            }
+        }
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        Stats s;
+        s.total = total_;
+        s.idle = (int)idle_.size();
+        s.inUse = total_ - (int)idle_.size();
+        s.max = maxSize_;
+        s.checkouts = checkouts_;
+        s.timeouts = timeouts_;
+        s.connectFailures = connectFailures_;
+        s.dropped = dropped_;
+        s.waitMicrosTotal = waitMicrosTotal_;
+        s.waitMicrosMax = waitMicrosMax_;
+        return s;
+    }
+
+    // 停止异步事件循环：等待已发出命令的回复（回调都执行完）后返回
+    void stopAsync()
+    {
+        async_.reset();
+    }
+
+    // 异步执行一条命令。开启 async 时由事件循环发出，调用线程不阻塞；
+    // 否则借一条同步连接当场执行，回调在调用线程中执行。
+    void commandAsync(std::vector<string> argv, RedisReplyCallback cb)
+    {
+        if (async_)
+        {
+            async_->command(std::move(argv), std::move(cb));
+            return;
+        }
+
+        std::vector<const char *> args;
+        std::vector<size_t> lens;
+        for (const auto &a : argv)
+        {
+            args.push_back(a.data());
+            lens.push_back(a.size());
+        }
+        redisReply *r = nullptr;
+        {
+            Lease c = acquire();
+            if (c)
+                r = (redisReply *)redisCommandArgv(c.get(), (int)args.size(), args.data(), lens.data());
+            else
+                std::cerr << "Redis checkout timed out" << std::endl;
         }
-        redisContext *c = pool_.back();
-        pool_.pop_back();
-        // 检查连接是否健康
+        if (cb)
+            cb(r);
+        if (r)
+            freeReplyObject(r);
+    }
+
+private:
+    struct Idle
+    {
+        redisContext *c;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    // 建一条带超时的连接；失败时记录并进入退避，返回 nullptr（不持锁调用）
+    redisContext *connectOne()
+    {
+        struct timeval tv;
+        tv.tv_sec = cfg_.connect_timeout_ms / 1000;
+        tv.tv_usec = (cfg_.connect_timeout_ms % 1000) * 1000;
+        redisContext *c = redisConnectWithTimeout(cfg_.host.c_str(), cfg_.port, tv);
+        if (c && !c->err)
+        {
+            struct timeval cmd;
+            cmd.tv_sec = cfg_.command_timeout_ms / 1000;
+            cmd.tv_usec = (cfg_.command_timeout_ms % 1000) * 1000;
+            redisSetTimeout(c, cmd);
+            std::lock_guard<std::mutex> lk(mtx_);
+            backoffMs_ = 0;
+            nextConnectAt_ = std::chrono::steady_clock::time_point{};
+            return c;
+        }
+
+        std::cerr << "Redis connect error: " << (c ? c->errstr : "allocation failed") << std::endl;
+        if (c)
+            redisFree(c);
+        std::lock_guard<std::mutex> lk(mtx_);
+        ++connectFailures_;
+        backoffMs_ = backoffMs_ == 0 ? 100 : std::min(backoffMs_ * 2, 5000);
+        nextConnectAt_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoffMs_);
+        return nullptr;
+    }
+
+    void giveBack(redisContext *c)
+    {
         if (c->err)
         {
-            std::cerr << "Redis connection err, reconnecting: " << c->errstr << std::endl;
+            // 出错的连接不再复用，腾出名额，下次借用时按需重建
+            std::cerr << "Redis connection dropped: " << c->errstr << std::endl;
             redisFree(c);
-            c = redisConnect(cfg_.host.c_str(), cfg_.port);
-            if (!c || c->err)
             {
-                throw std::runtime_error("Redis reconnect failed");
+                std::lock_guard<std::mutex> lk(mtx_);
+                --total_;
+                ++dropped_;
+            }
+            cv_.notify_one();
+            maintainCv_.notify_one();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            // 缩容后超出上限的连接归还时直接关闭
+            if (total_ > maxSize_)
+            {
+                --total_;
+                redisFree(c);
+                return;
             }
+            idle_.push_back(Idle{c, std::chrono::steady_clock::now()});
         }
-        return c;
+        cv_.notify_one();
+    }
+
+    void recordCheckout(std::chrono::steady_clock::time_point begin)
+    {
+        uint64_t us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+        ++checkouts_;
+        waitMicrosTotal_ += us;
+        if (us > waitMicrosMax_)
+            waitMicrosMax_ = us;
     }
 
-    void put(redisContext *c)
+    // 后台维护：PING 空闲连接、回收多余空闲连接、补齐到 min
+    void maintainLoop()
     {
+        const auto interval = std::chrono::milliseconds(cfg_.health_interval_ms > 0 ? cfg_.health_interval_ms : 5000);
+        const auto idleTimeout = std::chrono::milliseconds(cfg_.idle_timeout_ms > 0 ? cfg_.idle_timeout_ms : 60000);
         std::unique_lock<std::mutex> lk(mtx_);
-        pool_.push_back(c);
-        cv_.notify_one();
+        while (!stop_)
+        {
+            maintainCv_.wait_for(lk, interval);
+            if (stop_)
+                break;
+
+            // 取出全部空闲连接在锁外检查，期间借用方可以新建连接
+            std::vector<Idle> checking;
+            checking.swap(idle_);
+            lk.unlock();
+
+            auto now = std::chrono::steady_clock::now();
+            std::vector<Idle> healthy;
+            std::vector<redisContext *> closing;
+            int bad = 0;
+            for (auto &i : checking)
+            {
+                redisReply *r = (redisReply *)redisCommand(i.c, "PING");
+                bool ok = r && r->type != REDIS_REPLY_ERROR && !i.c->err;
+                if (r)
+                    freeReplyObject(r);
+                if (ok)
+                {
+                    healthy.push_back(i);
+                }
+                else
+                {
+                    closing.push_back(i.c);
+                    ++bad;
+                }
+            }
+
+            lk.lock();
+            total_ -= (int)closing.size();
+            dropped_ += bad;
+            // 多余的长时间空闲连接回收，保留至少 min 条
+            int idleTimedOut = 0;
+            for (auto &i : healthy)
+            {
+                if (total_ > minSize_ && now - i.since > idleTimeout)
+                {
+                    closing.push_back(i.c);
+                    --total_;
+                    ++idleTimedOut;
+                }
+                else
+                {
+                    idle_.push_back(i);
+                }
+            }
+            int missing = minSize_ - total_;
+            bool canConnect = std::chrono::steady_clock::now() >= nextConnectAt_;
+            if (missing > 0 && canConnect)
+                total_ += missing;
+            else
+                missing = 0;
+            lk.unlock();
+            cv_.notify_all();
+
+            for (redisContext *c : closing)
+                redisFree(c);
+            if (bad > 0)
+                std::cerr << "[Redis] health check dropped " << bad << " connection(s)" << std::endl;
+
+            int created = 0;
+            for (int i = 0; i < missing; ++i)
+            {
+                redisContext *c = connectOne();
+                if (!c)
+                    break;
+                std::lock_guard<std::mutex> g(mtx_);
+                idle_.push_back(Idle{c, std::chrono::steady_clock::now()});
+                ++created;
+                cv_.notify_one();
+            }
+
+            lk.lock();
+            total_ -= missing - created;
+        }
     }
 
-private:
     RedisConfig cfg_;
-    std::vector<redisContext *> pool_;
+    int minSize_ = 0;
+    int maxSize_ = 0;
+    std::unique_ptr<RedisAsyncLoop> async_;
+
     std::mutex mtx_;
-    std::condition_variable cv_;
+    std::condition_variable cv_;         // 等待空闲连接
+    std::condition_variable maintainCv_; // 唤醒后台维护线程
+    std::vector<Idle> idle_;
+    int total_ = 0;
+    bool stop_ = false;
+    int backoffMs_ = 0;
+    std::chrono::steady_clock::time_point nextConnectAt_{};
+
+    uint64_t checkouts_ = 0;
+    uint64_t timeouts_ = 0;
+    uint64_t connectFailures_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t waitMicrosTotal_ = 0;
+    uint64_t waitMicrosMax_ = 0;
+
+    std::thread maintainer_;
 };
 
 #endif // !REDISPOOL
@@ -0,0 +1,178 @@
+#ifndef SMTPRELAY_H
+#define SMTPRELAY_H
+
+#include "config/config.h"
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// ============ 多 SMTP 中继的选路与熔断 ============
+// - 平滑加权轮询（nginx SWRR）在可用中继间分配，权重比例稳定且不会连续扎堆到同一家
+// - 每个中继有全局并发上限（跨所有驱动线程），打满时该中继暂不参与选路
+// - 按秒分桶的滑动窗口统计暂时性错误率，超过阈值即熔断一段时间；
+//   冷却结束后半开放行一个探测请求，成功则恢复，失败则继续熔断
+// 收件人被拒（5xx）之类的永久错误说明中继本身是通的，按成功计入健康度。
+class SmtpRelaySet
+{
+public:
+    enum Pick
+    {
+        kBusy = -1,      // 有健康中继但都打满了并发，稍后再选
+        kNoHealthy = -2, // 可选中继全部熔断
+    };
+
+    struct Options
+    {
+        int windowSec = 10;         // 错误率统计窗口
+        int minRequests = 10;       // 窗口内请求数不足时不熔断
+        int errorThresholdPct = 50; // 暂时性错误占比达到即熔断
+        int openMs = 15000;         // 熔断持续时间
+    };
+
+    SmtpRelaySet(const std::vector<SmtpRelayConfig> &relays, const Options &opts)
+        : opts_(opts)
+    {
+        if (opts_.windowSec <= 0)
+            opts_.windowSec = 10;
+        for (const auto &cfg : relays)
+        {
+            Relay r;
+            r.cfg = cfg;
+            if (r.cfg.weight <= 0)
+                r.cfg.weight = 1;
+            r.window.resize(opts_.windowSec);
+            relays_.push_back(std::move(r));
+        }
+    }
+
+    size_t size() const { return relays_.size(); }
+
+    const SmtpRelayConfig &config(int index) const { return relays_[index].cfg; }
+
+    // 选一个中继并占用一个并发名额；excludeMask 中的中继（本次已失败过的）不参与
+    int acquire(uint64_t excludeMask)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lk(mtx_);
+        int total = 0;
+        int best = -1;
+        bool anyHealthy = false;
+        for (size_t i = 0; i < relays_.size(); ++i)
+        {
+            Relay &r = relays_[i];
+            if (i < 64 && (excludeMask >> i) & 1)
+                continue;
+            bool closed = r.state == State::kClosed;
+            bool probe = r.state == State::kOpen && now >= r.openUntil;
+            if (!closed && !probe)
+                continue;
+            anyHealthy = true;
+            if (probe ? r.inFlight > 0 : (r.cfg.max_concurrent > 0 && r.inFlight >= r.cfg.max_concurrent))
+                continue;
+            r.currentWeight += r.cfg.weight;
+            total += r.cfg.weight;
+            if (best < 0 || r.currentWeight > relays_[best].currentWeight)
+                best = (int)i;
+        }
+        if (best < 0)
+            return anyHealthy ? kBusy : kNoHealthy;
+
+        Relay &chosen = relays_[best];
+        chosen.currentWeight -= total;
+        ++chosen.inFlight;
+        if (chosen.state == State::kOpen)
+        {
+            // 冷却结束：放行这一个探测请求，其余请求在结果出来前继续绕开
+            chosen.state = State::kHalfOpen;
+            std::cout << "[SMTP] relay " << chosen.cfg.url << " half-open, probing" << std::endl;
+        }
+        return best;
+    }
+
+    // 释放名额并记录结果；transientFailure 表示连接 / 超时 / 4xx 限流等中继侧问题
+    void release(int index, bool transientFailure)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lk(mtx_);
+        Relay &r = relays_[index];
+        --r.inFlight;
+
+        if (r.state == State::kHalfOpen)
+        {
+            if (transientFailure)
+            {
+                open(r, now);
+            }
+            else
+            {
+                r.state = State::kClosed;
+                for (auto &b : r.window)
+                    b = Bucket();
+                std::cout << "[SMTP] relay " << r.cfg.url << " recovered" << std::endl;
+            }
+            return;
+        }
+
+        int64_t sec = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+        Bucket &b = r.window[sec % r.window.size()];
+        if (b.sec != sec)
+            b = Bucket{sec, 0, 0};
+        if (transientFailure)
+            ++b.failures;
+        else
+            ++b.successes;
+
+        if (r.state != State::kClosed || !transientFailure)
+            return;
+        int ok = 0, failed = 0;
+        for (const auto &w : r.window)
+        {
+            if (sec - w.sec < (int64_t)r.window.size())
+            {
+                ok += w.successes;
+                failed += w.failures;
+            }
+        }
+        int totalReq = ok + failed;
+        if (totalReq >= opts_.minRequests && failed * 100 >= opts_.errorThresholdPct * totalReq)
+            open(r, now);
+    }
+
+private:
+    enum class State
+    {
+        kClosed,
+        kOpen,
+        kHalfOpen,
+    };
+
+    struct Bucket
+    {
+        int64_t sec = -1;
+        int successes = 0;
+        int failures = 0;
+    };
+
+    struct Relay
+    {
+        SmtpRelayConfig cfg;
+        State state = State::kClosed;
+        std::chrono::steady_clock::time_point openUntil{};
+        int inFlight = 0;
+        int currentWeight = 0;
+        std::vector<Bucket> window;
+    };
+
+    void open(Relay &r, std::chrono::steady_clock::time_point now)
+    {
+        r.state = State::kOpen;
+        r.openUntil = now + std::chrono::milliseconds(opts_.openMs);
+        std::cerr << "[SMTP] relay " << r.cfg.url << " circuit open for " << opts_.openMs << "ms" << std::endl;
+    }
+
+    Options opts_;
+    std::mutex mtx_;
+    std::vector<Relay> relays_;
+};
+
+#endif // !SMTPRELAY_H
@@ -0,0 +1,387 @@
+#ifndef SMTPTRANSPORT_H
+#define SMTPTRANSPORT_H
+
+#include "config/config.h"
+#include "smtprelay.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============ 基于 curl multi 的 SMTP 发送通道 ============
+// 少量驱动线程，每个线程一个 CURLM，在其上并发跑多封邮件。
+// 完成的 easy handle 放回空闲池复用；连接留在 multi 的连接缓存里，
+// 下一封发往同一服务器、同一账号的邮件直接复用已完成 TLS + AUTH 的连接，只需 MAIL FROM / RCPT TO / DATA 几个往返。
+// 可配置多个中继：每封邮件开始时由 SmtpRelaySet 选路；暂时性失败时立即换一个没试过的健康中继重发，
+// 全部试过或都已熔断才把失败回调给上层（由上层按退避重试）。
+// 单封邮件的发送结果
+struct SmtpResult
+{
+    bool ok = false;
+    bool retryable = false; // 连接 / 超时 / 4xx 等暂时性错误，稍后重试可能成功
+    bool aborted = false;   // 停机时被 cancelPending() 放弃，没有发送结果
+    long responseCode = 0;  // 最后一条 SMTP 应答码，未拿到时为 0
+    string err;
+};
+
+class SmtpTransport
+{
+public:
+    using Callback = std::function<void(const SmtpResult &result)>;
+
+    struct Options
+    {
+        int threads = 2;                // 驱动线程数
+        int maxConcurrentPerThread = 8; // 每个线程同时在途的邮件数（也是每线程的连接上限）
+        long connectTimeoutSec = 30;
+        long timeoutSec = 60;
+        long maxIdleConnSec = 30; // 空闲连接最长保留时间，避免服务器先断开
+    };
+
+    SmtpTransport(const SmtpConfig &cfg, const Options &opts)
+        : cfg_(cfg), opts_(opts), relays_(relayList(cfg_), relayOptions(cfg_))
+    {
+        int n = opts_.threads > 0 ? opts_.threads : 1;
+        for (int i = 0; i < n; ++i)
+            drivers_.emplace_back(new Driver(*this));
+        for (auto &d : drivers_)
+            d->thread = std::thread(&SmtpTransport::driverLoop, this, d.get());
+    }
+
+    ~SmtpTransport()
+    {
+        stop_.store(true);
+        for (auto &d : drivers_)
+            curl_multi_wakeup(d->multi);
+        for (auto &d : drivers_)
+        {
+            if (d->thread.joinable())
+                d->thread.join();
+        }
+    }
+
+    // 停机超过排空期限时调用：排队的邮件不再开始，在途的传输中止，一律以 aborted 回调；
+    // 之后提交的邮件同样直接回调，析构不再等 SMTP 超时
+    void cancelPending()
+    {
+        cancel_.store(true);
+        for (auto &d : drivers_)
+            curl_multi_wakeup(d->multi);
+    }
+
+    SmtpTransport(const SmtpTransport &) = delete;
+    SmtpTransport &operator=(const SmtpTransport &) = delete;
+
+    // 异步发送：payload 为完整的 RFC 5322 报文（含头部），回调在驱动线程中执行
+    void sendAsync(const string &to, string payload, Callback cb)
+    {
+        auto job = std::make_unique<Job>();
+        job->to = to;
+        job->payload = std::move(payload);
+        job->cb = std::move(cb);
+
+        Driver &d = *drivers_[next_.fetch_add(1, std::memory_order_relaxed) % drivers_.size()];
+        {
+            std::lock_guard<std::mutex> lk(d.mtx);
+            d.inbox.push_back(std::move(job));
+        }
+        curl_multi_wakeup(d.multi);
+    }
+
+private:
+    struct Job
+    {
+        string to;
+        string payload;
+        size_t pos = 0;
+        curl_slist *recipients = nullptr;
+        Callback cb;
+        CURL *easy = nullptr;
+        int relay = -1;
+        uint64_t tried = 0;     // 本封邮件已失败过的中继
+        SmtpResult lastFailure; // 换中继后仍失败时回报给上层的错误
+    };
+
+    struct Driver
+    {
+        explicit Driver(SmtpTransport &owner)
+        {
+            multi = curl_multi_init();
+            // 连接缓存上限 = 并发上限 × 中继数，保证每个在途传输都能留住自己的连接
+            long relays = owner.relays_.size() > 0 ? (long)owner.relays_.size() : 1;
+            curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, (long)owner.opts_.maxConcurrentPerThread * relays);
+            curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)owner.opts_.maxConcurrentPerThread);
+        }
+        ~Driver()
+        {
+            for (CURL *e : idle)
+                curl_easy_cleanup(e);
+            curl_multi_cleanup(multi);
+        }
+
+        CURLM *multi = nullptr;
+        std::thread thread;
+        std::mutex mtx;
+        std::deque<std::unique_ptr<Job>> inbox; // 其它线程提交，驱动线程取走
+        std::deque<std::unique_ptr<Job>> waiting; // 超过并发上限时排队
+        std::vector<CURL *> idle;               // 可复用的 easy handle
+        std::vector<CURL *> active;             // 在途的 easy handle
+        int running = 0;
+    };
+
+    static size_t readPayload(void *ptr, size_t size, size_t nmemb, void *userp)
+    {
+        Job *job = (Job *)userp;
+        size_t room = size * nmemb;
+        size_t left = job->payload.size() - job->pos;
+        size_t tocopy = left < room ? left : room;
+        memcpy(ptr, job->payload.data() + job->pos, tocopy);
+        job->pos += tocopy;
+        return tocopy;
+    }
+
+    static std::vector<SmtpRelayConfig> relayList(const SmtpConfig &cfg)
+    {
+        if (!cfg.relays.empty())
+            return cfg.relays;
+        return {SmtpRelayConfig{cfg.url, cfg.user, cfg.pass, 1, 0}};
+    }
+
+    static SmtpRelaySet::Options relayOptions(const SmtpConfig &cfg)
+    {
+        SmtpRelaySet::Options o;
+        o.windowSec = cfg.relay_window_sec;
+        o.minRequests = cfg.relay_min_requests;
+        o.errorThresholdPct = cfg.relay_error_threshold_pct;
+        o.openMs = cfg.relay_open_ms;
+        return o;
+    }
+
+    void start(Driver &d, std::unique_ptr<Job> job, int relay)
+    {
+        CURL *curl = nullptr;
+        if (!d.idle.empty())
+        {
+            curl = d.idle.back();
+            d.idle.pop_back();
+            // reset 只清选项，连接仍在 multi 的缓存里
+            curl_easy_reset(curl);
+        }
+        else
+        {
+            curl = curl_easy_init();
+        }
+        if (!curl)
+        {
+            relays_.release(relay, false);
+            SmtpResult result;
+            result.retryable = true;
+            result.err = "curl init failed";
+            job->cb(result);
+            return;
+        }
+
+        const SmtpRelayConfig &rc = relays_.config(relay);
+        job->easy = curl;
+        job->relay = relay;
+        job->pos = 0;
+        job->recipients = curl_slist_append(nullptr, ("<" + job->to + ">").c_str());
+
+        curl_easy_setopt(curl, CURLOPT_URL, rc.url.c_str());
+        curl_easy_setopt(curl, CURLOPT_USERNAME, rc.user.c_str());
+        curl_easy_setopt(curl, CURLOPT_PASSWORD, rc.pass.c_str());
+        curl_easy_setopt(curl, CURLOPT_MAIL_FROM, ("<" + cfg_.from + ">").c_str());
+        curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, job->recipients);
+        // 关键：SMTP AUTH LOGIN（国内 SMTP 必须）
+        curl_easy_setopt(curl, CURLOPT_LOGIN_OPTIONS, "AUTH=LOGIN");
+
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, readPayload);
+        curl_easy_setopt(curl, CURLOPT_READDATA, job.get());
+        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+
+        curl_easy_setopt(curl, CURLOPT_USE_SSL, (long)CURLUSESSL_ALL);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, opts_.connectTimeoutSec);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, opts_.timeoutSec);
+        curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, opts_.maxIdleConnSec);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, job.get());
+        curl_multi_add_handle(d.multi, curl);
+        d.active.push_back(curl);
+        ++d.running;
+        job.release(); // 由 finish() 回收
+    }
+
+    void finish(Driver &d, CURL *curl, CURLcode res, bool aborted = false)
+    {
+        Job *raw = nullptr;
+        curl_easy_getinfo(curl, CURLINFO_PRIVATE, &raw);
+        std::unique_ptr<Job> job(raw);
+        SmtpResult result;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &result.responseCode);
+        curl_multi_remove_handle(d.multi, curl);
+        d.active.erase(std::find(d.active.begin(), d.active.end(), curl));
+        --d.running;
+
+        curl_slist_free_all(job->recipients);
+        job->recipients = nullptr;
+        job->easy = nullptr;
+        d.idle.push_back(curl);
+
+        result.ok = res == CURLE_OK;
+        if (!result.ok)
+        {
+            result.retryable = isRetryable(res, result.responseCode);
+            result.err = curl_easy_strerror(res);
+            if (result.responseCode > 0)
+                result.err += " (smtp " + std::to_string(result.responseCode) + ")";
+        }
+        if (aborted)
+        {
+            // 中止不是中继的问题，不计入熔断统计
+            relays_.release(job->relay, false);
+            job->cb(abortedResult());
+            return;
+        }
+        relays_.release(job->relay, !result.ok && result.retryable);
+
+        // 中继侧的暂时性失败：还有没试过的中继就立即换一个重发
+        if (!result.ok && result.retryable && job->relay < 64)
+        {
+            job->tried |= 1ull << job->relay;
+            job->lastFailure = result;
+            if ((size_t)__builtin_popcountll(job->tried) < relays_.size())
+            {
+                d.waiting.push_front(std::move(job));
+                return;
+            }
+        }
+        job->cb(result);
+    }
+
+    static SmtpResult abortedResult()
+    {
+        SmtpResult result;
+        result.retryable = true;
+        result.aborted = true;
+        result.err = "aborted on shutdown";
+        return result;
+    }
+
+    // 放弃本线程的全部邮件：在途的先中止，再回调排队中的
+    void abortAll(Driver &d)
+    {
+        while (!d.active.empty())
+            finish(d, d.active.back(), CURLE_ABORTED_BY_CALLBACK, true);
+        while (!d.waiting.empty())
+        {
+            std::unique_ptr<Job> job = std::move(d.waiting.front());
+            d.waiting.pop_front();
+            job->cb(abortedResult());
+        }
+    }
+
+    // 5xx 为永久拒绝（如收件人不存在），配置类错误重试也无用；其余按暂时性错误处理
+    static bool isRetryable(CURLcode res, long responseCode)
+    {
+        if (responseCode >= 500 && responseCode < 600)
+            return false;
+        if (responseCode >= 400 && responseCode < 500)
+            return true;
+        switch (res)
+        {
+        case CURLE_URL_MALFORMAT:
+        case CURLE_UNSUPPORTED_PROTOCOL:
+        case CURLE_BAD_FUNCTION_ARGUMENT:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    void driverLoop(Driver *dp)
+    {
+        Driver &d = *dp;
+        const int cap = opts_.maxConcurrentPerThread > 0 ? opts_.maxConcurrentPerThread : 1;
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lk(d.mtx);
+                while (!d.inbox.empty())
+                {
+                    d.waiting.push_back(std::move(d.inbox.front()));
+                    d.inbox.pop_front();
+                }
+            }
+            if (cancel_.load())
+                abortAll(d);
+            bool relayBusy = false;
+            while (d.running < cap && !d.waiting.empty())
+            {
+                int relay = relays_.acquire(d.waiting.front()->tried);
+                if (relay == SmtpRelaySet::kBusy)
+                {
+                    // 中继并发打满（名额可能被其它驱动线程占着），稍后再选
+                    relayBusy = true;
+                    break;
+                }
+                std::unique_ptr<Job> job = std::move(d.waiting.front());
+                d.waiting.pop_front();
+                if (relay == SmtpRelaySet::kNoHealthy)
+                {
+                    SmtpResult result = job->lastFailure;
+                    if (result.err.empty())
+                    {
+                        result.retryable = true;
+                        result.err = "no healthy SMTP relay";
+                    }
+                    job->cb(result);
+                    continue;
+                }
+                start(d, std::move(job), relay);
+            }
+
+            // 停止时把已提交的邮件发完再退出
+            if (stop_.load() && d.running == 0 && d.waiting.empty())
+            {
+                std::lock_guard<std::mutex> lk(d.mtx);
+                if (d.inbox.empty())
+                    break;
+            }
+
+            int stillRunning = 0;
+            curl_multi_perform(d.multi, &stillRunning);
+
+            int msgsLeft = 0;
+            while (CURLMsg *msg = curl_multi_info_read(d.multi, &msgsLeft))
+            {
+                if (msg->msg == CURLMSG_DONE)
+                    finish(d, msg->easy_handle, msg->data.result);
+            }
+
+            if (relayBusy)
+                curl_multi_poll(d.multi, nullptr, 0, 20, nullptr);
+            else if (d.running > 0 || d.waiting.empty())
+                curl_multi_poll(d.multi, nullptr, 0, 1000, nullptr);
+        }
+    }
+
+    SmtpConfig cfg_;
+    Options opts_;
+    SmtpRelaySet relays_;
+    std::vector<std::unique_ptr<Driver>> drivers_;
+    std::atomic<size_t> next_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> cancel_{false};
+};
+
+#endif // !SMTPTRANSPORT_H
@@ -0,0 +1,95 @@
+// EmailTemplate / CodeEmailRenderer：占位符替换、CRLF、HTML 转义与整封报文结构
+#include "emailtemplate.h"
+#include <drogon/drogon_test.h>
+
+namespace
+{
+    std::string render(const EmailTemplate &tpl, const EmailVars &vars)
+    {
+        std::string out;
+        tpl.renderTo(out, vars);
+        return out;
+    }
+
+    bool endsWith(const std::string &s, const std::string &suffix)
+    {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    const EmailVars kVars{"123456", "5", "a<b>@example.com"};
+}
+
+DROGON_TEST(EmailTemplateSubstitutesVariables)
+{
+    EmailTemplate tpl("code={{code}}, ttl={{ ttl_min }}, to={{email}}", false);
+    const std::string out = render(tpl, kVars);
+    CHECK(out == "code=123456, ttl=5, to=a<b>@example.com");
+    CHECK(tpl.size(kVars) == out.size());
+}
+
+DROGON_TEST(EmailTemplateKeepsUnknownPlaceholders)
+{
+    CHECK(render(EmailTemplate("{{name}} {{code}}", false), kVars) == "{{name}} 123456");
+    CHECK(render(EmailTemplate("broken {{code", false), kVars) == "broken {{code");
+    CHECK(render(EmailTemplate("{{}}", false), kVars) == "{{}}");
+    CHECK(EmailTemplate("", false).empty());
+}
+
+DROGON_TEST(EmailTemplateNormalizesLineEndings)
+{
+    // 裸 \n 统一成 \r\n，已有的 \r\n 不重复加 \r
+    CHECK(render(EmailTemplate("a\nb\r\nc\n{{code}}\n", false), kVars) == "a\r\nb\r\nc\r\n123456\r\n");
+    CHECK(render(EmailTemplate("\n", false), kVars) == "\r\n");
+}
+
+DROGON_TEST(EmailTemplateEscapesHtmlValues)
+{
+    EmailTemplate html("<p>{{email}}</p>", true);
+    const std::string out = render(html, kVars);
+    // 只转义变量，模板自身的标签原样输出
+    CHECK(out == "<p>a&lt;b&gt;@example.com</p>");
+    CHECK(html.size(kVars) == out.size());
+
+    const EmailVars quoted{"\"&\"", "1", "x"};
+    CHECK(render(EmailTemplate("{{code}}", true), quoted) == "&quot;&amp;&quot;");
+    CHECK(render(EmailTemplate("{{code}}", false), quoted) == "\"&\"");
+}
+
+DROGON_TEST(CodeEmailRendererPlainText)
+{
+    SmtpConfig smtp;
+    smtp.from = "noreply@example.com";
+    smtp.from_name = "CloudDisk";
+    EmailBizConfig email{};
+    email.subject_template = "Code {{code}}";
+    email.text_template = "Your code: {{code}}";
+    email.html_template.clear();
+
+    const std::string out = CodeEmailRenderer(smtp, email).render("user@example.com", kVars);
+    CHECK(out.rfind("From: CloudDisk <noreply@example.com>\r\nTo: <user@example.com>\r\nSubject: Code 123456\r\n", 0) == 0);
+    CHECK(out.find("Content-Type: text/plain; charset=UTF-8") != std::string::npos);
+    CHECK(out.find("multipart") == std::string::npos);
+    CHECK(endsWith(out, "\r\n\r\nYour code: 123456\r\n"));
+}
+
+DROGON_TEST(CodeEmailRendererMultipart)
+{
+    SmtpConfig smtp;
+    smtp.from = "noreply@example.com";
+    smtp.from_name = "CloudDisk";
+    EmailBizConfig email{};
+    email.subject_template = "Code";
+    email.text_template = "{{code}}";
+    email.html_template = "<b>{{code}}</b> for {{email}}";
+
+    const std::string out = CodeEmailRenderer(smtp, email).render("u@example.com", kVars);
+    const std::string boundary = "=_clouddisk_alt_boundary";
+    CHECK(out.find("Content-Type: multipart/alternative; boundary=\"" + boundary + "\"") != std::string::npos);
+    const size_t text = out.find("Content-Type: text/plain");
+    const size_t html = out.find("Content-Type: text/html");
+    REQUIRE(text != std::string::npos);
+    REQUIRE(html != std::string::npos);
+    CHECK(text < html);
+    CHECK(out.find("<b>123456</b> for a&lt;b&gt;@example.com") != std::string::npos);
+    CHECK(endsWith(out, "\r\n--" + boundary + "--\r\n"));
+}
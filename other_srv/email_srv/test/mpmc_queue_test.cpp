@@ -0,0 +1,134 @@
+// BoundedMpmcQueue / WorkStealingPool：容量、FIFO、并发下不丢不重
+#include "workstealingpool.h"
+#include <drogon/drogon_test.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+DROGON_TEST(MpmcQueueCapacityAndOrder)
+{
+    // 容量向上取整到 2 的幂
+    BoundedMpmcQueue<int> q(5);
+    REQUIRE(q.capacity() == 8);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        int v = i;
+        CHECK(q.tryPush(std::move(v)));
+    }
+    int extra = 100;
+    CHECK(!q.tryPush(std::move(extra)));
+    CHECK(extra == 100); // 满时不移走元素
+
+    int out = -1;
+    for (int i = 0; i < 8; ++i)
+    {
+        REQUIRE(q.tryPop(out));
+        CHECK(out == i);
+    }
+    CHECK(!q.tryPop(out));
+
+    // 绕过一圈后仍可用
+    for (int round = 0; round < 3; ++round)
+    {
+        int v = round;
+        CHECK(q.tryPush(std::move(v)));
+        CHECK(q.tryPop(out));
+        CHECK(out == round);
+    }
+}
+
+DROGON_TEST(MpmcQueueMovesAndDestroysElements)
+{
+    auto tracked = std::make_shared<int>(7);
+    {
+        BoundedMpmcQueue<std::shared_ptr<int>> q(4);
+        auto a = tracked, b = tracked;
+        CHECK(q.tryPush(std::move(a)));
+        CHECK(q.tryPush(std::move(b)));
+        CHECK(!a);
+        CHECK(tracked.use_count() == 3);
+
+        std::shared_ptr<int> out;
+        REQUIRE(q.tryPop(out));
+        CHECK(*out == 7);
+        out.reset();
+        CHECK(tracked.use_count() == 2);
+    }
+    // 析构时释放仍在队列中的元素
+    CHECK(tracked.use_count() == 1);
+}
+
+DROGON_TEST(MpmcQueueConcurrentProducersConsumers)
+{
+    constexpr int kProducers = 4, kConsumers = 4, kPerProducer = 20000;
+    BoundedMpmcQueue<int> q(256);
+    std::vector<std::atomic<int>> seen(kProducers * kPerProducer);
+    std::atomic<int> consumed{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p)
+    {
+        threads.emplace_back([&q, p]
+                             {
+            for (int i = 0; i < kPerProducer; ++i)
+            {
+                int v = p * kPerProducer + i;
+                while (!q.tryPush(std::move(v)))
+                    std::this_thread::yield();
+            } });
+    }
+    for (int c = 0; c < kConsumers; ++c)
+    {
+        threads.emplace_back([&]
+                             {
+            int v;
+            while (consumed.load() < kProducers * kPerProducer)
+            {
+                if (q.tryPop(v))
+                {
+                    seen[v].fetch_add(1);
+                    consumed.fetch_add(1);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            } });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    // 每个元素恰好出队一次
+    int missing = 0, duplicated = 0;
+    for (auto &s : seen)
+    {
+        missing += s.load() == 0;
+        duplicated += s.load() > 1;
+    }
+    CHECK(missing == 0);
+    CHECK(duplicated == 0);
+}
+
+DROGON_TEST(WorkStealingPoolRunsEverySubmittedTask)
+{
+    std::atomic<int> ran{0};
+    {
+        WorkStealingPool<int> pool(4, 64, [&ran](int &&)
+                                   { ran.fetch_add(1); },
+                                   2);
+        int accepted = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            int v = i;
+            while (!pool.submit(std::move(v), i % 2))
+                std::this_thread::yield();
+            ++accepted;
+        }
+        CHECK(accepted == 1000);
+        pool.stop(); // 已入队的任务在 worker 退出前执行完
+    }
+    CHECK(ran.load() == 1000);
+}
@@ -0,0 +1,93 @@
+// OffsetTracker：提交点只前进到连续完成的前缀
+#include "offsettracker.h"
+#include <drogon/drogon_test.h>
+
+namespace
+{
+    // 取出某个分区本次前进到的提交点，没有前进返回 -1
+    int64_t collectFor(OffsetTracker &tracker, int32_t partition)
+    {
+        int64_t offset = -1;
+        for (const auto &c : tracker.collect())
+        {
+            if (c.partition == partition)
+                offset = c.offset;
+        }
+        return offset;
+    }
+}
+
+DROGON_TEST(OffsetTrackerCommitsContiguousPrefix)
+{
+    OffsetTracker tracker;
+    const uint64_t gen = tracker.reset();
+    for (int64_t off = 10; off < 14; ++off)
+        tracker.begin(0, off);
+    CHECK(tracker.inFlight() == 4);
+
+    // 乱序完成：10 未完成时提交点停在 10
+    tracker.complete(gen, 0, 12);
+    tracker.complete(gen, 0, 11);
+    CHECK(collectFor(tracker, 0) == 10);
+    CHECK(tracker.collect().empty()); // 没有前进不重复返回
+
+    tracker.complete(gen, 0, 10);
+    CHECK(collectFor(tracker, 0) == 13);
+    tracker.complete(gen, 0, 13);
+    CHECK(collectFor(tracker, 0) == 14);
+    CHECK(tracker.inFlight() == 0);
+}
+
+DROGON_TEST(OffsetTrackerAbandonHoldsCommitPoint)
+{
+    OffsetTracker tracker;
+    const uint64_t gen = tracker.reset();
+    tracker.begin(3, 100);
+    tracker.begin(3, 101);
+    tracker.begin(3, 102);
+
+    // 放弃的消息不再计入在途，但提交点不能越过它，重启后要重投
+    tracker.abandon(gen, 3, 101);
+    tracker.complete(gen, 3, 100);
+    tracker.complete(gen, 3, 102);
+    CHECK(tracker.inFlight() == 0);
+    CHECK(collectFor(tracker, 3) == 101);
+    CHECK(tracker.collect().empty());
+}
+
+DROGON_TEST(OffsetTrackerIgnoresStaleGeneration)
+{
+    OffsetTracker tracker;
+    const uint64_t oldGen = tracker.reset();
+    tracker.begin(0, 5);
+
+    // 分区重新分配后，旧一代的回执不能影响新一代
+    const uint64_t gen = tracker.reset();
+    CHECK(gen != oldGen);
+    CHECK(tracker.inFlight() == 0);
+    tracker.begin(0, 7);
+    tracker.complete(oldGen, 0, 7);
+    tracker.abandon(oldGen, 0, 7);
+    CHECK(tracker.inFlight() == 1);
+    CHECK(collectFor(tracker, 0) == 7);
+
+    tracker.complete(gen, 0, 7);
+    CHECK(collectFor(tracker, 0) == 8);
+}
+
+DROGON_TEST(OffsetTrackerPartitionsAreIndependent)
+{
+    OffsetTracker tracker;
+    const uint64_t gen = tracker.reset();
+    tracker.begin(0, 1);
+    tracker.begin(1, 50);
+    tracker.complete(gen, 1, 50);
+
+    auto commits = tracker.collect();
+    int64_t p0 = -1, p1 = -1;
+    for (const auto &c : commits)
+        (c.partition == 0 ? p0 : p1) = c.offset;
+    CHECK(p0 == 1);
+    CHECK(p1 == 51);
+    CHECK(tracker.inFlight() == 1);
+}
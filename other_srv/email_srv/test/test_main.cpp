@@ -0,0 +1,8 @@
+#define DROGON_TEST_MAIN
+#include <drogon/drogon_test.h>
+
+// 这里的用例都不依赖事件循环，直接跑测试框架即可
+int main(int argc, char **argv)
+{
+    return drogon::test::run(argc, argv);
+}
@@ -0,0 +1,139 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+// ============ 单层哈希时间轮 ============
+// 固定 tick 推进一格，到期任务在时间轮线程里执行（应只做入队之类的轻量操作）。
+// 超过一圈的延迟用 rounds 计数，插入 / 到期都是 O(1)，大量待重试任务也不需要堆排序。
+class TimerWheel
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit TimerWheel(int tickMs = 100, size_t slots = 512)
+        : tickMs_(tickMs > 0 ? tickMs : 100),
+          slots_(slots > 0 ? slots : 512)
+    {
+        thread_ = std::thread(&TimerWheel::loop, this);
+    }
+
+    ~TimerWheel()
+    {
+        stop(false);
+    }
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    // 已停止时返回 false，任务不会执行
+    bool schedule(int64_t delayMs, Task task)
+    {
+        uint64_t ticks = delayMs <= 0 ? 1 : (uint64_t)((delayMs + tickMs_ - 1) / tickMs_);
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (stopped_)
+            return false;
+        size_t slot = (cursor_ + ticks) % slots_.size();
+        slots_[slot].push_back(Entry{(ticks - 1) / slots_.size(), std::move(task)});
+        ++size_;
+        return true;
+    }
+
+    // runPending=true 时把尚未到期的任务立即执行一遍（停机前给重试最后一次机会）
+    void stop(bool runPending)
+    {
+        std::vector<Task> pending;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (stopped_)
+                return;
+            stopped_ = true;
+            for (auto &slot : slots_)
+            {
+                for (auto &e : slot)
+                    pending.push_back(std::move(e.task));
+                slot.clear();
+            }
+            size_ = 0;
+        }
+        cv_.notify_all();
+        if (thread_.joinable())
+            thread_.join();
+        if (runPending)
+        {
+            for (auto &t : pending)
+                t();
+        }
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return size_;
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t rounds;
+        Task task;
+    };
+
+    void loop()
+    {
+        auto next = std::chrono::steady_clock::now() + std::chrono::milliseconds(tickMs_);
+        std::vector<Task> due;
+        std::unique_lock<std::mutex> lk(mtx_);
+        while (!stopped_)
+        {
+            if (cv_.wait_until(lk, next, [this]
+                               { return stopped_; }))
+                break;
+            next += std::chrono::milliseconds(tickMs_);
+
+            cursor_ = (cursor_ + 1) % slots_.size();
+            auto &slot = slots_[cursor_];
+            for (size_t i = 0; i < slot.size();)
+            {
+                if (slot[i].rounds == 0)
+                {
+                    due.push_back(std::move(slot[i].task));
+                    slot[i] = std::move(slot.back());
+                    slot.pop_back();
+                    --size_;
+                }
+                else
+                {
+                    --slot[i].rounds;
+                    ++i;
+                }
+            }
+
+            if (!due.empty())
+            {
+                lk.unlock();
+                for (auto &t : due)
+                    t();
+                due.clear();
+                lk.lock();
+            }
+        }
+    }
+
+    const int tickMs_;
+    std::vector<std::vector<Entry>> slots_;
+    size_t cursor_ = 0;
+    size_t size_ = 0;
+    bool stopped_ = false;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+#endif // !TIMERWHEEL_H
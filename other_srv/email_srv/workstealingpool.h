@@ -0,0 +1,290 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ============ 有界无锁 MPMC 环形队列（Vyukov） ============
+// 每个槽位带一个序号，生产者/消费者各自 CAS 推进位置，槽位内元素按值移动，不加锁也不分配内存。
+template <typename T>
+class BoundedMpmcQueue
+{
+public:
+    explicit BoundedMpmcQueue(size_t capacity)
+    {
+        size_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i)
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    ~BoundedMpmcQueue()
+    {
+        T tmp;
+        while (tryPop(tmp))
+        {
+        }
+    }
+
+    BoundedMpmcQueue(const BoundedMpmcQueue &) = delete;
+    BoundedMpmcQueue &operator=(const BoundedMpmcQueue &) = delete;
+
+    // 队列满返回 false，v 保持不变
+    bool tryPush(T &&v)
+    {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[pos & mask_];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    new (cell.storage) T(std::move(v));
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 队列空返回 false
+    bool tryPop(T &out)
+    {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[pos & mask_];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    T *p = std::launder(reinterpret_cast<T *>(cell.storage));
+                    out = std::move(*p);
+                    p->~T();
+                    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+    alignas(64) size_t mask_ = 0;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+// ============ 工作窃取线程池 ============
+// 每个 worker 一个有界无锁队列；提交方按轮转选择队列，满了就试下一个，全部满时返回 false（背压）。
+// worker 先取自己的队列，空了再从其它 worker 的队列里偷；都空时在条件变量上休眠，
+// 只有存在休眠 worker 时提交方才去拿锁唤醒，忙时整条路径无锁。
+// 可选多条优先级通道（lane 0 最高）：每个 worker 每条通道各一个队列，取任务时按通道从高到低找；
+// 为防低优先级饿死，每连续处理 kStarvationGuard 个高优先级任务后先看一次低优先级通道。
+template <typename T>
+class WorkStealingPool
+{
+public:
+    using Handler = std::function<void(T &&)>;
+
+    WorkStealingPool(size_t workers, size_t queueCapacityPerWorker, Handler handler, size_t lanes = 1)
+        : handler_(std::move(handler))
+    {
+        if (workers == 0)
+            workers = 1;
+        if (lanes == 0)
+            lanes = 1;
+        workers_ = workers;
+        lanes_.resize(lanes);
+        for (auto &lane : lanes_)
+        {
+            lane.reserve(workers);
+            for (size_t i = 0; i < workers; ++i)
+                lane.emplace_back(new BoundedMpmcQueue<T>(queueCapacityPerWorker));
+        }
+        threads_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i)
+            threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+
+    ~WorkStealingPool()
+    {
+        stop();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // 提交任务（移动）到指定通道；该通道所有队列都满时返回 false，task 保持不变
+    bool submit(T &&task, size_t lane = 0)
+    {
+        if (lane >= lanes_.size())
+            lane = lanes_.size() - 1;
+        auto &queues = lanes_[lane];
+        const size_t n = queues.size();
+        size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+        // 先计数再入队：pending_ 不会小于实际排队数，worker 看到 0 时一定无活可干
+        pending_.fetch_add(1, std::memory_order_seq_cst);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (queues[(start + i) % n]->tryPush(std::move(task)))
+            {
+                if (sleepers_.load(std::memory_order_seq_cst) > 0)
+                {
+                    std::lock_guard<std::mutex> lk(sleepMtx_);
+                    sleepCv_.notify_one();
+                }
+                return true;
+            }
+        }
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 停止并等待 worker 退出；已入队但未执行的任务在 worker 退出前执行完
+    void stop()
+    {
+        if (stop_.exchange(true))
+            return;
+        {
+            std::lock_guard<std::mutex> lk(sleepMtx_);
+            sleepCv_.notify_all();
+        }
+        for (auto &t : threads_)
+        {
+            if (t.joinable())
+                t.join();
+        }
+    }
+
+    size_t workers() const { return workers_; }
+    size_t lanes() const { return lanes_.size(); }
+
+    // 已入队未执行的任务数（近似值）
+    int64_t pending() const { return pending_.load(std::memory_order_relaxed); }
+
+private:
+    bool tryTakeLane(size_t lane, size_t self, T &out)
+    {
+        auto &queues = lanes_[lane];
+        if (queues[self]->tryPop(out))
+            return true;
+        const size_t n = queues.size();
+        for (size_t i = 1; i < n; ++i)
+        {
+            if (queues[(self + i) % n]->tryPop(out))
+                return true;
+        }
+        return false;
+    }
+
+    // highStreak：本 worker 连续处理高优先级任务的次数，用于防饿死
+    bool tryTake(size_t self, T &out, size_t &highStreak)
+    {
+        const size_t nLanes = lanes_.size();
+        if (nLanes > 1 && highStreak >= kStarvationGuard)
+        {
+            highStreak = 0;
+            for (size_t l = nLanes - 1; l > 0; --l)
+            {
+                if (tryTakeLane(l, self, out))
+                    return true;
+            }
+        }
+        for (size_t l = 0; l < nLanes; ++l)
+        {
+            if (tryTakeLane(l, self, out))
+            {
+                highStreak = l == 0 ? highStreak + 1 : 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t self)
+    {
+        T task;
+        size_t highStreak = 0;
+        for (;;)
+        {
+            if (tryTake(self, task, highStreak))
+            {
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                handler_(std::move(task));
+                continue;
+            }
+            if (stop_.load(std::memory_order_acquire))
+            {
+                if (pending_.load(std::memory_order_acquire) <= 0)
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lk(sleepMtx_);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            sleepCv_.wait(lk, [this]
+                          { return stop_.load(std::memory_order_acquire) ||
+                                   pending_.load(std::memory_order_seq_cst) > 0; });
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    static constexpr size_t kStarvationGuard = 16;
+
+    Handler handler_;
+    size_t workers_ = 0;
+    std::vector<std::vector<std::unique_ptr<BoundedMpmcQueue<T>>>> lanes_; // [lane][worker]
+    std::vector<std::thread> threads_;
+
+    alignas(64) std::atomic<size_t> next_{0};
+    alignas(64) std::atomic<int64_t> pending_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex sleepMtx_;
+    std::condition_variable sleepCv_;
+};
+
+#endif // !WORKSTEALINGPOOL_H